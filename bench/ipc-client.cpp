@@ -0,0 +1,143 @@
+#include "ipc-client.hpp"
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+namespace wf
+{
+namespace bench
+{
+ipc_client_t::ipc_client_t(const std::string& socket_path, int timeout_ms)
+{
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path))
+    {
+        throw std::runtime_error("IPC socket path is too long: " + socket_path);
+    }
+
+    std::strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (true)
+    {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+        {
+            throw std::runtime_error(std::string("Failed to create socket: ") + strerror(errno));
+        }
+
+        if (connect(fd, (sockaddr*)&addr, sizeof(addr)) == 0)
+        {
+            return;
+        }
+
+        const int error = errno;
+        close(fd);
+        fd = -1;
+
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            throw std::runtime_error("Failed to connect to " + socket_path + ": " + strerror(error));
+        }
+
+        // The compositor is probably still starting up
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+}
+
+ipc_client_t::~ipc_client_t()
+{
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+}
+
+void ipc_client_t::write_all(const char *buffer, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t written = write(fd, buffer, size);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw std::runtime_error(std::string("Failed to write to the IPC socket: ") + strerror(errno));
+        }
+
+        buffer += written;
+        size   -= written;
+    }
+}
+
+void ipc_client_t::read_all(char *buffer, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t r = read(fd, buffer, size);
+        if (r < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            throw std::runtime_error(std::string("Failed to read from the IPC socket: ") + strerror(errno));
+        }
+
+        if (r == 0)
+        {
+            throw std::runtime_error("The compositor closed the IPC connection");
+        }
+
+        buffer += r;
+        size   -= r;
+    }
+}
+
+wf::json_t ipc_client_t::call(const std::string& method, const wf::json_t& data)
+{
+    wf::json_t message;
+    message["method"] = method;
+    message["data"]   = data;
+
+    // Messages are prefixed with their length as a 32-bit integer in native byte order
+    message.map_serialized([&] (const char *buffer, size_t size)
+    {
+        uint32_t len = size;
+        write_all((const char*)&len, sizeof(len));
+        write_all(buffer, size);
+    });
+
+    uint32_t len;
+    read_all((char*)&len, sizeof(len));
+    std::string response(len, '\0');
+    read_all(response.data(), len);
+
+    wf::json_t result;
+    if (auto error = wf::json_t::parse_string(response, result))
+    {
+        throw std::runtime_error("Invalid response to " + method + ": " + *error);
+    }
+
+    if (result.has_member("error"))
+    {
+        throw std::runtime_error(method + " failed: " + result["error"].as_string());
+    }
+
+    return result;
+}
+}
+}
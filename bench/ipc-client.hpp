@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <wayfire/nonstd/json.hpp>
+
+namespace wf
+{
+namespace bench
+{
+/**
+ * A minimal blocking client for Wayfire's IPC socket.
+ */
+class ipc_client_t
+{
+  public:
+    /**
+     * Connect to the IPC socket at the given path, retrying until the
+     * compositor has created the socket or the timeout expires.
+     *
+     * @throws std::runtime_error if the connection could not be established.
+     */
+    ipc_client_t(const std::string& socket_path, int timeout_ms);
+    ~ipc_client_t();
+
+    ipc_client_t(const ipc_client_t&) = delete;
+    ipc_client_t& operator =(const ipc_client_t&) = delete;
+
+    /**
+     * Call an IPC method and wait for its response.
+     *
+     * @throws std::runtime_error if the connection was lost or the method
+     *   returned an error.
+     */
+    wf::json_t call(const std::string& method, const wf::json_t& data = {});
+
+  private:
+    int fd = -1;
+
+    void write_all(const char *buffer, size_t size);
+    void read_all(char *buffer, size_t size);
+};
+}
+}
@@ -0,0 +1,418 @@
+#include "shm-client.hpp"
+#include "xdg-shell-client-protocol.h"
+
+#include <wayland-client.h>
+#include <sys/mman.h>
+#include <poll.h>
+#include <unistd.h>
+#include <time.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace wf
+{
+namespace bench
+{
+namespace
+{
+int64_t get_time_us()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1'000'000ll + ts.tv_nsec / 1000;
+}
+
+/* A wl_shm buffer backed by a memfd, which is mapped in the client. */
+struct shm_buffer_t
+{
+    wl_buffer *buffer = nullptr;
+    uint32_t *data    = nullptr;
+    size_t size = 0;
+    int width   = 0;
+    int height  = 0;
+    /* Whether the compositor still uses the buffer */
+    bool busy = false;
+
+    static constexpr wl_buffer_listener listener = {
+        .release = [] (void *data, wl_buffer*)
+        {
+            ((shm_buffer_t*)data)->busy = false;
+        },
+    };
+
+    bool create(wl_shm *shm, int width, int height)
+    {
+        this->width  = width;
+        this->height = height;
+        const int stride = width * 4;
+        size = (size_t)stride * height;
+
+        int fd = memfd_create("wayfire-bench", MFD_CLOEXEC);
+        if ((fd < 0) || (ftruncate(fd, size) < 0))
+        {
+            std::cerr << "wayfire-bench: failed to create shm buffer: " << strerror(errno) << std::endl;
+            if (fd >= 0)
+            {
+                close(fd);
+            }
+
+            return false;
+        }
+
+        void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED)
+        {
+            std::cerr << "wayfire-bench: failed to map shm buffer: " << strerror(errno) << std::endl;
+            close(fd);
+            return false;
+        }
+
+        data = (uint32_t*)map;
+        auto pool = wl_shm_create_pool(shm, fd, size);
+        buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+        wl_shm_pool_destroy(pool);
+        close(fd);
+
+        wl_buffer_add_listener(buffer, &listener, this);
+        return true;
+    }
+
+    ~shm_buffer_t()
+    {
+        if (buffer)
+        {
+            wl_buffer_destroy(buffer);
+        }
+
+        if (data)
+        {
+            munmap(data, size);
+        }
+    }
+};
+
+class shm_client_t
+{
+    shm_client_options_t options;
+
+    wl_display *display = nullptr;
+    wl_registry *registry     = nullptr;
+    wl_compositor *compositor = nullptr;
+    wl_shm *shm = nullptr;
+    xdg_wm_base *wm_base = nullptr;
+
+    wl_surface *surface = nullptr;
+    xdg_surface *shell_surface = nullptr;
+    xdg_toplevel *toplevel     = nullptr;
+    wl_callback *frame_callback = nullptr;
+
+    std::vector<std::unique_ptr<shm_buffer_t>> buffers;
+    int width;
+    int height;
+    int pending_width  = 0;
+    int pending_height = 0;
+
+    bool configured = false;
+    bool running    = true;
+    /* Whether a frame callback arrived while all buffers were busy */
+    bool frame_pending     = false;
+    uint64_t frame_counter = 0;
+    int64_t next_commit    = 0;
+
+    void handle_configure(uint32_t serial)
+    {
+        xdg_surface_ack_configure(shell_surface, serial);
+        if ((pending_width > 0) && (pending_height > 0) &&
+            ((pending_width != width) || (pending_height != height)))
+        {
+            width  = pending_width;
+            height = pending_height;
+            buffers.clear();
+        }
+
+        if (!configured)
+        {
+            configured  = true;
+            next_commit = get_time_us();
+            commit_frame();
+        }
+    }
+
+    shm_buffer_t *get_free_buffer()
+    {
+        for (auto& buffer : buffers)
+        {
+            if (!buffer->busy)
+            {
+                return buffer.get();
+            }
+        }
+
+        // Clients usually need two buffers, and a third one when the compositor holds on to the first
+        if (buffers.size() >= 3)
+        {
+            return nullptr;
+        }
+
+        auto buffer = std::make_unique<shm_buffer_t>();
+        if (!buffer->create(shm, width, height))
+        {
+            running = false;
+            return nullptr;
+        }
+
+        std::fill(buffer->data, buffer->data + width * height, 0xff202020);
+        buffers.push_back(std::move(buffer));
+        return buffers.back().get();
+    }
+
+    /* Paint a band of the surface which moves down with each frame, and commit it. */
+    void commit_frame()
+    {
+        auto buffer = get_free_buffer();
+        if (!buffer)
+        {
+            // All buffers are in use. With a fixed commit rate, the frame is skipped, otherwise we commit
+            // as soon as a buffer is released.
+            frame_pending = (options.commit_rate <= 0);
+            return;
+        }
+
+        const int band = std::clamp((int)(height * options.damage), 1, height);
+        const int y    = (frame_counter * band) % height;
+        const int rows = std::min(band, height - y);
+        const uint32_t color = 0xff000000 | ((frame_counter * 0x10305) & 0xffffff);
+        std::fill(buffer->data + y * width, buffer->data + (y + rows) * width, color);
+        ++frame_counter;
+
+        wl_surface_attach(surface, buffer->buffer, 0, 0);
+        wl_surface_damage_buffer(surface, 0, y, width, rows);
+        if (options.commit_rate <= 0)
+        {
+            frame_callback = wl_surface_frame(surface);
+            wl_callback_add_listener(frame_callback, &frame_listener, this);
+        }
+
+        wl_surface_commit(surface);
+        buffer->busy = true;
+    }
+
+    /* @return The time until the next commit in milliseconds, or -1 if commits are driven by frame
+     * callbacks. */
+    int handle_commit_timer()
+    {
+        if (!configured || (options.commit_rate <= 0))
+        {
+            return -1;
+        }
+
+        const int64_t interval = 1'000'000 / options.commit_rate;
+        int64_t now = get_time_us();
+        if (now >= next_commit)
+        {
+            commit_frame();
+            next_commit += interval;
+            if (next_commit <= now)
+            {
+                // We are too slow to keep up, do not try to catch up with a burst of commits
+                next_commit = now + interval;
+            }
+        }
+
+        return (next_commit - now + 999) / 1000;
+    }
+
+    static constexpr wl_registry_listener registry_listener = {
+        .global = [] (void *data, wl_registry *registry, uint32_t name, const char *interface,
+            uint32_t version)
+        {
+            auto self = (shm_client_t*)data;
+            if (!strcmp(interface, wl_compositor_interface.name))
+            {
+                self->compositor = (wl_compositor*)wl_registry_bind(registry, name,
+                    &wl_compositor_interface, std::min(version, 4u));
+            } else if (!strcmp(interface, wl_shm_interface.name))
+            {
+                self->shm = (wl_shm*)wl_registry_bind(registry, name, &wl_shm_interface, 1);
+            } else if (!strcmp(interface, xdg_wm_base_interface.name))
+            {
+                self->wm_base = (xdg_wm_base*)wl_registry_bind(registry, name, &xdg_wm_base_interface, 1);
+            }
+        },
+        .global_remove = [] (void*, wl_registry*, uint32_t)
+        {},
+    };
+
+    static constexpr xdg_wm_base_listener wm_base_listener = {
+        .ping = [] (void*, xdg_wm_base *wm_base, uint32_t serial)
+        {
+            xdg_wm_base_pong(wm_base, serial);
+        },
+    };
+
+    static constexpr xdg_surface_listener shell_surface_listener = {
+        .configure = [] (void *data, xdg_surface*, uint32_t serial)
+        {
+            ((shm_client_t*)data)->handle_configure(serial);
+        },
+    };
+
+    static constexpr xdg_toplevel_listener toplevel_listener = {
+        .configure = [] (void *data, xdg_toplevel*, int32_t width, int32_t height, wl_array*)
+        {
+            auto self = (shm_client_t*)data;
+            self->pending_width  = width;
+            self->pending_height = height;
+        },
+        .close = [] (void *data, xdg_toplevel*)
+        {
+            ((shm_client_t*)data)->running = false;
+        },
+        .configure_bounds = [] (void*, xdg_toplevel*, int32_t, int32_t)
+        {},
+        .wm_capabilities  = [] (void*, xdg_toplevel*, wl_array*)
+        {},
+    };
+
+    static constexpr wl_callback_listener frame_listener = {
+        .done = [] (void *data, wl_callback *callback, uint32_t)
+        {
+            auto self = (shm_client_t*)data;
+            wl_callback_destroy(callback);
+            self->frame_callback = nullptr;
+            self->commit_frame();
+        },
+    };
+
+  public:
+    shm_client_t(const shm_client_options_t& options) : options(options)
+    {
+        width  = options.width;
+        height = options.height;
+    }
+
+    ~shm_client_t()
+    {
+        buffers.clear();
+        if (frame_callback)
+        {
+            wl_callback_destroy(frame_callback);
+        }
+
+        if (toplevel)
+        {
+            xdg_toplevel_destroy(toplevel);
+        }
+
+        if (shell_surface)
+        {
+            xdg_surface_destroy(shell_surface);
+        }
+
+        if (surface)
+        {
+            wl_surface_destroy(surface);
+        }
+
+        if (display)
+        {
+            wl_display_disconnect(display);
+        }
+    }
+
+    bool init()
+    {
+        display = wl_display_connect(nullptr);
+        if (!display)
+        {
+            std::cerr << "wayfire-bench: client failed to connect to the compositor" << std::endl;
+            return false;
+        }
+
+        registry = wl_display_get_registry(display);
+        wl_registry_add_listener(registry, &registry_listener, this);
+        wl_display_roundtrip(display);
+        if (!compositor || !shm || !wm_base)
+        {
+            std::cerr << "wayfire-bench: compositor does not support wl_shm xdg toplevels" << std::endl;
+            return false;
+        }
+
+        xdg_wm_base_add_listener(wm_base, &wm_base_listener, this);
+        surface = wl_compositor_create_surface(compositor);
+        shell_surface = xdg_wm_base_get_xdg_surface(wm_base, surface);
+        xdg_surface_add_listener(shell_surface, &shell_surface_listener, this);
+        toplevel = xdg_surface_get_toplevel(shell_surface);
+        xdg_toplevel_add_listener(toplevel, &toplevel_listener, this);
+        xdg_toplevel_set_title(toplevel, options.title.c_str());
+        xdg_toplevel_set_app_id(toplevel, "wayfire-bench");
+        wl_surface_commit(surface);
+        return true;
+    }
+
+    int run()
+    {
+        while (running)
+        {
+            if (frame_pending)
+            {
+                frame_pending = false;
+                commit_frame();
+            }
+
+            const int timeout = handle_commit_timer();
+            while (wl_display_prepare_read(display) != 0)
+            {
+                if (wl_display_dispatch_pending(display) < 0)
+                {
+                    return 1;
+                }
+            }
+
+            if ((wl_display_flush(display) < 0) && (errno != EAGAIN))
+            {
+                wl_display_cancel_read(display);
+                return 1;
+            }
+
+            pollfd fd = {.fd = wl_display_get_fd(display), .events = POLLIN, .revents = 0};
+            if (poll(&fd, 1, timeout) > 0)
+            {
+                if (wl_display_read_events(display) < 0)
+                {
+                    return 1;
+                }
+            } else
+            {
+                wl_display_cancel_read(display);
+            }
+
+            if (wl_display_dispatch_pending(display) < 0)
+            {
+                return 1;
+            }
+        }
+
+        return 0;
+    }
+};
+}
+
+int run_shm_client(const shm_client_options_t& options)
+{
+    shm_client_t client{options};
+    if (!client.init())
+    {
+        return 1;
+    }
+
+    return client.run();
+}
+}
+}
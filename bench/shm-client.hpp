@@ -0,0 +1,36 @@
+#pragma once
+
+#include <string>
+
+namespace wf
+{
+namespace bench
+{
+struct shm_client_options_t
+{
+    /** The title of the client's toplevel. */
+    std::string title = "wayfire-bench";
+    /** The initial size of the client's buffers. */
+    int width  = 640;
+    int height = 480;
+    /**
+     * How many times per second the client commits a new buffer.
+     * If zero, the client commits a new buffer on each frame callback.
+     */
+    double commit_rate = 60;
+    /** The fraction of the surface which is damaged on each commit. */
+    double damage = 0.1;
+};
+
+/**
+ * Run a synthetic Wayland client which shows a single xdg toplevel and keeps
+ * committing new wl_shm buffers to it.
+ *
+ * The client connects to the display from $WAYLAND_DISPLAY, and runs until the
+ * display connection is lost or the toplevel is closed.
+ *
+ * @return The exit status of the client.
+ */
+int run_shm_client(const shm_client_options_t& options);
+}
+}
@@ -0,0 +1,825 @@
+#include "ipc-client.hpp"
+#include "shm-client.hpp"
+
+#include <getopt.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+using steady_clock = std::chrono::steady_clock;
+
+namespace
+{
+struct bench_options_t
+{
+    std::string wayfire = "wayfire";
+    std::string log_file    = "/dev/null";
+    std::string output_file = "";
+    int clients = 4;
+    wf::bench::shm_client_options_t client;
+    int output_width  = 1920;
+    int output_height = 1080;
+    double phase_duration = 5.0;
+    std::vector<std::string> phases;
+};
+
+const char *CONFIG_TEMPLATE = R"([core]
+plugins = ipc ipc-rules stipc move scale expo
+xwayland = false
+
+[input]
+xkb_layout = us
+)";
+
+void print_help()
+{
+    std::cout << "Usage: wayfire-bench [OPTION]...\n" << std::endl;
+    std::cout << "Runs Wayfire on a headless output with synthetic clients, drives it through a sequence\n" <<
+        "of scripted phases and prints frame timings, CPU time and memory usage as JSON.\n" << std::endl;
+    std::cout << " -w,  --wayfire PATH       compositor executable to run (default: wayfire)" << std::endl;
+    std::cout << " -n,  --clients N          number of synthetic clients (default: 4)" << std::endl;
+    std::cout << " -r,  --rate HZ            commits per second of each client, " <<
+        "0 to commit on each frame callback (default: 60)" << std::endl;
+    std::cout << " -s,  --client-size WxH    initial size of the clients (default: 640x480)" << std::endl;
+    std::cout << " -d,  --damage FRACTION    fraction of each client damaged per commit (default: 0.1)" <<
+        std::endl;
+    std::cout << " -o,  --output-size WxH    size of the headless output (default: 1920x1080)" << std::endl;
+    std::cout << " -t,  --duration SECONDS   duration of each phase (default: 5)" << std::endl;
+    std::cout << " -p,  --phases LIST        comma-separated phases to run, out of idle, input, move, " <<
+        "scale and expo (default: all)" << std::endl;
+    std::cout << " -l,  --log FILE           file to write the compositor's log to (default: /dev/null)" <<
+        std::endl;
+    std::cout << " -f,  --file FILE          file to write the results to (default: stdout)" << std::endl;
+    std::cout << " -h,  --help               print this help" << std::endl;
+}
+
+bool parse_size(const char *str, int& width, int& height)
+{
+    return (sscanf(str, "%dx%d", &width, &height) == 2) && (width > 0) && (height > 0);
+}
+
+std::vector<std::string> split(const std::string& str, char separator)
+{
+    std::vector<std::string> result;
+    std::stringstream ss(str);
+    std::string entry;
+    while (std::getline(ss, entry, separator))
+    {
+        if (!entry.empty())
+        {
+            result.push_back(entry);
+        }
+    }
+
+    return result;
+}
+
+/* wf::json_t distinguishes signed and unsigned integers, numbers parsed from a response are mostly unsigned. */
+int64_t json_to_int(const wf::json_t& json)
+{
+    if (json.is_int64())
+    {
+        return (int64_t)json;
+    } else if (json.is_uint64())
+    {
+        return (int64_t)(uint64_t)json;
+    } else if (json.is_double())
+    {
+        return (int64_t)(double)json;
+    }
+
+    return 0;
+}
+
+const std::vector<std::string> KNOWN_PHASES = {"idle", "input", "move", "scale", "expo"};
+
+struct process_usage_t
+{
+    /* User and system CPU time in microseconds */
+    int64_t cpu_time = 0;
+    int64_t rss_kb   = 0;
+    int64_t peak_rss_kb = 0;
+};
+
+process_usage_t get_process_usage(pid_t pid)
+{
+    process_usage_t usage;
+
+    std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+    std::string line;
+    if (std::getline(stat, line))
+    {
+        // The process name may contain spaces, so start parsing after it. utime and stime are the 14th
+        // and 15th fields, counting the pid and the name.
+        std::stringstream fields(line.substr(line.rfind(')') + 2));
+        std::string field;
+        int64_t utime = 0, stime = 0;
+        for (int i = 3; (i <= 15) && (fields >> field); i++)
+        {
+            if (i == 14)
+            {
+                utime = std::stoll(field);
+            } else if (i == 15)
+            {
+                stime = std::stoll(field);
+            }
+        }
+
+        usage.cpu_time = (utime + stime) * 1'000'000 / sysconf(_SC_CLK_TCK);
+    }
+
+    std::ifstream status("/proc/" + std::to_string(pid) + "/status");
+    while (std::getline(status, line))
+    {
+        if (line.rfind("VmRSS:", 0) == 0)
+        {
+            usage.rss_kb = std::stoll(line.substr(6));
+        } else if (line.rfind("VmHWM:", 0) == 0)
+        {
+            usage.peak_rss_kb = std::stoll(line.substr(6));
+        }
+    }
+
+    return usage;
+}
+
+/* Summarize a set of samples with their average and nearest-rank percentiles. */
+wf::json_t summarize(std::vector<int64_t> samples)
+{
+    wf::json_t summary;
+    if (samples.empty())
+    {
+        return summary;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    auto percentile = [&] (double p)
+    {
+        size_t rank = std::ceil(p / 100.0 * samples.size());
+        return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+    };
+
+    double sum = 0;
+    for (auto sample : samples)
+    {
+        sum += sample;
+    }
+
+    summary["avg"] = sum / samples.size();
+    summary["p50"] = percentile(50);
+    summary["p90"] = percentile(90);
+    summary["p99"] = percentile(99);
+    summary["max"] = samples.back();
+    return summary;
+}
+
+struct view_t
+{
+    uint64_t id;
+    int x = 0;
+    int y = 0;
+    int width  = 0;
+    int height = 0;
+};
+
+class benchmark_t
+{
+  public:
+    benchmark_t(const bench_options_t& options) : options(options)
+    {}
+
+    ~benchmark_t()
+    {
+        ipc.reset();
+        for (auto client : clients)
+        {
+            kill(client, SIGTERM);
+        }
+
+        if (compositor > 0)
+        {
+            kill(compositor, SIGTERM);
+            wait_for_exit(compositor);
+        }
+
+        for (auto client : clients)
+        {
+            wait_for_exit(client);
+        }
+
+        if (!tmp_dir.empty())
+        {
+            unlink((tmp_dir + "/wayfire.ini").c_str());
+            unlink((tmp_dir + "/ipc.sock").c_str());
+            rmdir(tmp_dir.c_str());
+        }
+    }
+
+    wf::json_t run()
+    {
+        start_compositor();
+        start_clients();
+
+        wf::json_t result;
+        result["compositor"] = options.wayfire;
+        result["clients"]    = options.clients;
+        result["commit-rate"] = options.client.commit_rate;
+        result["damage"] = options.client.damage;
+        result["client-size"]["width"]  = options.client.width;
+        result["client-size"]["height"] = options.client.height;
+        result["output-size"]["width"]  = options.output_width;
+        result["output-size"]["height"] = options.output_height;
+        result["phase-duration"] = options.phase_duration;
+
+        wf::json_t phases = wf::json_t::array();
+        for (auto& phase : options.phases)
+        {
+            phases.append(run_phase(phase));
+        }
+
+        result["phases"] = phases;
+        return result;
+    }
+
+  private:
+    bench_options_t options;
+    std::string tmp_dir;
+    pid_t compositor = -1;
+    std::vector<pid_t> clients;
+    std::unique_ptr<wf::bench::ipc_client_t> ipc;
+
+    uint64_t output_id = 0;
+    int output_x = 0;
+    int output_y = 0;
+    std::vector<view_t> views;
+
+    static void wait_for_exit(pid_t pid)
+    {
+        auto deadline = steady_clock::now() + 5s;
+        while (waitpid(pid, nullptr, WNOHANG) == 0)
+        {
+            if (steady_clock::now() >= deadline)
+            {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+                return;
+            }
+
+            std::this_thread::sleep_for(10ms);
+        }
+    }
+
+    static pid_t spawn(std::function<int()> child)
+    {
+        pid_t pid = fork();
+        if (pid < 0)
+        {
+            throw std::runtime_error(std::string("fork() failed: ") + strerror(errno));
+        }
+
+        if (pid == 0)
+        {
+            _exit(child());
+        }
+
+        return pid;
+    }
+
+    void start_compositor()
+    {
+        const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+        if (!runtime_dir)
+        {
+            throw std::runtime_error("XDG_RUNTIME_DIR is not set");
+        }
+
+        std::string tmp_template = std::string(runtime_dir) + "/wayfire-bench-XXXXXX";
+        if (!mkdtemp(tmp_template.data()))
+        {
+            throw std::runtime_error(std::string("Failed to create a temporary directory: ") +
+                strerror(errno));
+        }
+
+        tmp_dir = tmp_template;
+        const std::string config = tmp_dir + "/wayfire.ini";
+        const std::string socket = tmp_dir + "/ipc.sock";
+        std::ofstream(config) << CONFIG_TEMPLATE;
+
+        compositor = spawn([&] ()
+        {
+            int log = open(options.log_file.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (log >= 0)
+            {
+                dup2(log, STDOUT_FILENO);
+                dup2(log, STDERR_FILENO);
+                close(log);
+            }
+
+            setenv("WLR_BACKENDS", "headless", 1);
+            setenv("WLR_LIBINPUT_NO_DEVICES", "1", 1);
+            setenv("_WAYFIRE_SOCKET", socket.c_str(), 1);
+            unsetenv("WAYLAND_DISPLAY");
+            unsetenv("WAYLAND_SOCKET");
+            unsetenv("DISPLAY");
+
+            execlp(options.wayfire.c_str(), options.wayfire.c_str(), "-c", config.c_str(), nullptr);
+            std::cerr << "wayfire-bench: failed to run " << options.wayfire << ": " << strerror(errno) <<
+                std::endl;
+            return 127;
+        });
+
+        ipc = std::make_unique<wf::bench::ipc_client_t>(socket, 10'000);
+
+        wf::json_t output_size;
+        output_size["width"]  = (uint64_t)options.output_width;
+        output_size["height"] = (uint64_t)options.output_height;
+        auto output = ipc->call("wayfire/create-headless-output", output_size)["output"];
+        output_id = json_to_int(output["id"]);
+        output_x  = json_to_int(output["geometry"]["x"]);
+        output_y  = json_to_int(output["geometry"]["y"]);
+    }
+
+    void start_clients()
+    {
+        const std::string display = ipc->call("stipc/get_display")["wayland"].as_string();
+        for (int i = 0; i < options.clients; i++)
+        {
+            auto client_options  = options.client;
+            client_options.title = "wayfire-bench-" + std::to_string(i);
+            clients.push_back(spawn([&] ()
+            {
+                setenv("WAYLAND_DISPLAY", display.c_str(), 1);
+                return wf::bench::run_shm_client(client_options);
+            }));
+        }
+
+        // Wait until all clients are mapped
+        auto deadline = steady_clock::now() + 10s;
+        while (true)
+        {
+            views.clear();
+            auto list = ipc->call("window-rules/list-views");
+            for (size_t i = 0; i < list.size(); i++)
+            {
+                if ((list[i]["app-id"].as_string() == "wayfire-bench") && (bool)list[i]["mapped"])
+                {
+                    views.push_back(view_t{.id = (uint64_t)json_to_int(list[i]["id"])});
+                }
+            }
+
+            if ((int)views.size() >= options.clients)
+            {
+                break;
+            }
+
+            if (steady_clock::now() >= deadline)
+            {
+                throw std::runtime_error("Only " + std::to_string(views.size()) + " of " +
+                    std::to_string(options.clients) + " clients were mapped");
+            }
+
+            std::this_thread::sleep_for(50ms);
+        }
+
+        layout_views();
+    }
+
+    /* Arrange the clients in a grid, so that all of them are visible. */
+    void layout_views()
+    {
+        const int columns = std::ceil(std::sqrt(views.size()));
+        const int rows    = (views.size() + columns - 1) / columns;
+        const int cell_width  = options.output_width / columns;
+        const int cell_height = options.output_height / rows;
+
+        wf::json_t layout;
+        layout["views"] = wf::json_t::array();
+        for (size_t i = 0; i < views.size(); i++)
+        {
+            auto& view = views[i];
+            view.width  = std::min(options.client.width, cell_width);
+            view.height = std::min(options.client.height, cell_height);
+            view.x = output_x + (i % columns) * cell_width;
+            view.y = output_y + (i / columns) * cell_height;
+
+            wf::json_t v;
+            v["id"]     = view.id;
+            v["x"]      = (int64_t)view.x;
+            v["y"]      = (int64_t)view.y;
+            v["width"]  = (int64_t)view.width;
+            v["height"] = (int64_t)view.height;
+            layout["views"].append(v);
+        }
+
+        ipc->call("stipc/layout_views", layout);
+    }
+
+    /* Collects the timings of the frames painted on the output since the collector was created. */
+    class frame_collector_t
+    {
+      public:
+        frame_collector_t(wf::bench::ipc_client_t& ipc, uint64_t output_id) : ipc(ipc), output_id(output_id)
+        {
+            auto stats = query(false);
+            last_painted  = json_to_int(stats["painted"]);
+            start_skipped = json_to_int(stats["skipped"]);
+            start_missed  = json_to_int(stats["missed"]);
+        }
+
+        /* Fetch the frames painted since the last update. The compositor only keeps a limited number of
+         * frames, so this has to be called regularly. */
+        void update()
+        {
+            auto stats    = query(true);
+            const auto& frames = stats["frames"];
+            auto painted  = json_to_int(stats["painted"]);
+            int64_t count = painted - last_painted;
+            if (count > (int64_t)frames.size())
+            {
+                lost_frames += count - frames.size();
+                count = frames.size();
+            }
+
+            for (size_t i = frames.size() - count; i < frames.size(); i++)
+            {
+                for (auto& name : frames[i].get_member_names())
+                {
+                    timings[name].push_back(json_to_int(frames[i][name]));
+                }
+            }
+
+            last_painted = painted;
+            skipped = json_to_int(stats["skipped"]) - start_skipped;
+            missed  = json_to_int(stats["missed"]) - start_missed;
+        }
+
+        std::map<std::string, std::vector<int64_t>> timings;
+        int64_t lost_frames = 0;
+        int64_t skipped     = 0;
+        int64_t missed = 0;
+
+      private:
+        wf::bench::ipc_client_t& ipc;
+        uint64_t output_id;
+        int64_t last_painted;
+        int64_t start_skipped;
+        int64_t start_missed;
+
+        wf::json_t query(bool include_frames)
+        {
+            wf::json_t request;
+            request["output-id"] = output_id;
+            request["include-frames"] = include_frames;
+            return ipc.call("wayfire/get-frame-timings", request)["outputs"][0];
+        }
+    };
+
+    void move_cursor(double x, double y)
+    {
+        wf::json_t position;
+        position["x"] = x;
+        position["y"] = y;
+        ipc->call("stipc/move_cursor", position);
+    }
+
+    void feed_button(const std::string& combo, const std::string& mode)
+    {
+        wf::json_t button;
+        button["combo"] = combo;
+        button["mode"]  = mode;
+        ipc->call("stipc/feed_button", button);
+    }
+
+    void feed_key(const std::string& key, bool state)
+    {
+        wf::json_t data;
+        data["key"]   = key;
+        data["state"] = state;
+        ipc->call("stipc/feed_key", data);
+    }
+
+    void toggle_plugin(const std::string& method)
+    {
+        wf::json_t data;
+        data["output_id"] = output_id;
+        ipc->call(method, data);
+    }
+
+    /* Move the cursor over the whole output, t is the time since the start of the phase in seconds. */
+    void sweep_cursor(double t)
+    {
+        const double phase = std::fmod(t / 2.0, 1.0);
+        move_cursor(output_x + options.output_width * phase,
+            output_y + options.output_height * (0.5 + 0.4 * std::sin(t * M_PI)));
+    }
+
+    /**
+     * The scripted phases. Each phase is driven by a callback which is called about once per
+     * frame with the time since the start of the phase in seconds, and once more with a negative time
+     * when the phase ends.
+     */
+    std::function<void(double)> get_phase_script(const std::string& name)
+    {
+        const double duration = options.phase_duration;
+        if (name == "idle")
+        {
+            return [] (double) {};
+        }
+
+        if (name == "input")
+        {
+            // Type into the focused client while moving the cursor over all clients
+            return [=, last_key = -1] (double t) mutable
+            {
+                const int key = (t < 0) ? -1 : (int)(t * 20);
+                if (key != last_key)
+                {
+                    if (last_key >= 0)
+                    {
+                        feed_key("KEY_A", false);
+                    }
+
+                    if (key >= 0)
+                    {
+                        feed_key("KEY_A", true);
+                    }
+
+                    last_key = key;
+                }
+
+                if (t >= 0)
+                {
+                    sweep_cursor(t);
+                }
+            };
+        }
+
+        if (name == "move")
+        {
+            // Drag the first client around in circles
+            return [=, started = false] (double t) mutable
+            {
+                auto& view = views.front();
+                const double cx = view.x + view.width / 2.0;
+                const double cy = view.y + view.height / 2.0;
+                if (t < 0)
+                {
+                    feed_button("S-BTN_LEFT", "release");
+                    return;
+                }
+
+                if (!started)
+                {
+                    move_cursor(cx, cy);
+                    feed_button("S-BTN_LEFT", "press");
+                    started = true;
+                }
+
+                const double radius = std::min(options.output_width, options.output_height) / 4.0;
+                move_cursor(cx + radius * std::sin(t * M_PI), cy - radius * std::cos(t * M_PI) + radius);
+            };
+        }
+
+        if ((name == "scale") || (name == "expo"))
+        {
+            // Activate the plugin, hover over the clients or workspaces, and deactivate it again
+            // halfway through, so that both animations are measured.
+            const std::string method = name + "/toggle";
+            return [=, toggles = 0] (double t) mutable
+            {
+                if (t < 0)
+                {
+                    if (toggles == 1)
+                    {
+                        toggle_plugin(method);
+                    }
+
+                    return;
+                }
+
+                if ((toggles == 0) || ((toggles == 1) && (t >= duration / 2)))
+                {
+                    toggle_plugin(method);
+                    ++toggles;
+                }
+
+                sweep_cursor(t);
+            };
+        }
+
+        throw std::runtime_error("Unknown phase \"" + name + "\"");
+    }
+
+    wf::json_t run_phase(const std::string& name)
+    {
+        auto script = get_phase_script(name);
+
+        frame_collector_t frames{*ipc, output_id};
+        auto compositor_start = get_process_usage(compositor);
+        int64_t clients_start = get_clients_cpu_time();
+
+        const auto start = steady_clock::now();
+        const auto end   = start + std::chrono::duration_cast<steady_clock::duration>(
+            std::chrono::duration<double>(options.phase_duration));
+        auto next_update = start + 250ms;
+        for (auto now = start; now < end; now = steady_clock::now())
+        {
+            script(std::chrono::duration<double>(now - start).count());
+            if (now >= next_update)
+            {
+                frames.update();
+                next_update += 250ms;
+            }
+
+            std::this_thread::sleep_until(std::min(now + 16ms, end));
+        }
+
+        script(-1);
+        frames.update();
+
+        const double elapsed = std::chrono::duration<double>(steady_clock::now() - start).count();
+        auto compositor_end = get_process_usage(compositor);
+        const int64_t compositor_cpu = compositor_end.cpu_time - compositor_start.cpu_time;
+        const int64_t clients_cpu    = get_clients_cpu_time() - clients_start;
+
+        wf::json_t result;
+        result["name"]     = name;
+        result["duration"] = elapsed;
+        result["painted"]  = (int64_t)frames.timings["total"].size();
+        result["fps"]     = frames.timings["total"].size() / elapsed;
+        result["skipped"] = frames.skipped;
+        result["missed"]  = frames.missed;
+        result["lost-samples"] = frames.lost_frames;
+        result["frame-time-us"] = summarize(frames.timings["total"]);
+
+        wf::json_t timings;
+        for (auto& [timing, samples] : frames.timings)
+        {
+            timings[timing] = summarize(samples);
+        }
+
+        result["timings"] = timings;
+        result["compositor-cpu-ms"]   = compositor_cpu / 1000.0;
+        result["compositor-cpu-load"] = compositor_cpu / 1e6 / elapsed;
+        result["clients-cpu-ms"] = clients_cpu / 1000.0;
+        result["rss-kb"]      = compositor_end.rss_kb;
+        result["peak-rss-kb"] = compositor_end.peak_rss_kb;
+        return result;
+    }
+
+    int64_t get_clients_cpu_time()
+    {
+        int64_t total = 0;
+        for (auto client : clients)
+        {
+            total += get_process_usage(client).cpu_time;
+        }
+
+        return total;
+    }
+};
+
+int run(const bench_options_t& options)
+{
+    wf::json_t result;
+    try {
+        benchmark_t benchmark{options};
+        result = benchmark.run();
+    } catch (const std::exception& e)
+    {
+        std::cerr << "wayfire-bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::ofstream file;
+    if (!options.output_file.empty())
+    {
+        file.open(options.output_file);
+    }
+
+    std::ostream& out = options.output_file.empty() ? std::cout : file;
+    result.map_serialized([&] (const char *buffer, size_t size)
+    {
+        out.write(buffer, size);
+    });
+    out << std::endl;
+    return out.good() ? 0 : 1;
+}
+}
+
+int main(int argc, char **argv)
+{
+    bench_options_t options;
+    options.phases = KNOWN_PHASES;
+    struct option opts[] = {
+        {"wayfire", required_argument, NULL, 'w'},
+        {"clients", required_argument, NULL, 'n'},
+        {"rate", required_argument, NULL, 'r'},
+        {"client-size", required_argument, NULL, 's'},
+        {"damage", required_argument, NULL, 'd'},
+        {"output-size", required_argument, NULL, 'o'},
+        {"duration", required_argument, NULL, 't'},
+        {"phases", required_argument, NULL, 'p'},
+        {"log", required_argument, NULL, 'l'},
+        {"file", required_argument, NULL, 'f'},
+        {"help", no_argument, NULL, 'h'},
+        {0, 0, NULL, 0}
+    };
+
+    int c, i;
+    while ((c = getopt_long(argc, argv, "w:n:r:s:d:o:t:p:l:f:h", opts, &i)) != -1)
+    {
+        switch (c)
+        {
+          case 'w':
+            options.wayfire = optarg;
+            break;
+
+          case 'n':
+            options.clients = std::max(1, atoi(optarg));
+            break;
+
+          case 'r':
+            options.client.commit_rate = std::max(0.0, atof(optarg));
+            break;
+
+          case 's':
+            if (!parse_size(optarg, options.client.width, options.client.height))
+            {
+                std::cerr << "wayfire-bench: invalid client size " << optarg << std::endl;
+                return 1;
+            }
+
+            break;
+
+          case 'd':
+            options.client.damage = std::clamp(atof(optarg), 0.0, 1.0);
+            break;
+
+          case 'o':
+            if (!parse_size(optarg, options.output_width, options.output_height))
+            {
+                std::cerr << "wayfire-bench: invalid output size " << optarg << std::endl;
+                return 1;
+            }
+
+            break;
+
+          case 't':
+            options.phase_duration = std::max(0.5, atof(optarg));
+            break;
+
+          case 'p':
+            options.phases = split(optarg, ',');
+            for (auto& phase : options.phases)
+            {
+                if (std::find(KNOWN_PHASES.begin(), KNOWN_PHASES.end(), phase) == KNOWN_PHASES.end())
+                {
+                    std::cerr << "wayfire-bench: unknown phase " << phase << std::endl;
+                    return 1;
+                }
+            }
+
+            break;
+
+          case 'l':
+            options.log_file = optarg;
+            break;
+
+          case 'f':
+            options.output_file = optarg;
+            break;
+
+          case 'h':
+            print_help();
+            return 0;
+
+          default:
+            print_help();
+            return 1;
+        }
+    }
+
+    // Report a lost connection to the compositor as an error instead of being killed
+    signal(SIGPIPE, SIG_IGN);
+    return run(options);
+}
@@ -259,7 +259,7 @@ class wayfire_animation : public wf::plugin_interface_t, private wf::per_output_
     void cleanup_views_on_output(wf::output_t *output)
     {
         std::vector<std::shared_ptr<wf::view_interface_t>> all_views;
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             all_views.push_back(view->shared_from_this());
         }
@@ -0,0 +1,162 @@
+#include "particle-arrays.hpp"
+#include <algorithm>
+#include <cmath>
+
+#ifdef _OPENMP
+    #include <omp.h>
+#endif
+
+int ParticleArrays::spawn(int num, const ParticleIniter& init)
+{
+    /* The initer is usually not thread-safe (it uses rand()), and spawning
+     * is cheap compared to updating, so do it on a single thread. */
+    int spawned = 0;
+    for (int i = 0; i < size() && spawned < num; i++)
+    {
+        if (life[i] <= 0)
+        {
+            Particle p;
+            init(p);
+            set(i, p);
+            ++spawned;
+        }
+    }
+
+    particles_alive += spawned;
+    return spawned;
+}
+
+void ParticleArrays::set(int i, const Particle& p)
+{
+    life[i] = p.life;
+    fade[i] = p.fade;
+    radius[i]      = p.radius;
+    base_radius[i] = p.base_radius;
+
+    center[center_per_particle * i]     = p.pos.x;
+    center[center_per_particle * i + 1] = p.pos.y;
+    speed_x[i] = p.speed.x;
+    speed_y[i] = p.speed.y;
+    g_x[i]     = p.g.x;
+    g_y[i]     = p.g.y;
+    start_x[i] = p.start_pos.x;
+
+    for (int j = 0; j < color_per_particle; j++)
+    {
+        color[color_per_particle * i + j] = p.color[j];
+    }
+}
+
+void ParticleArrays::resize(int num)
+{
+    if (num == size())
+    {
+        return;
+    }
+
+    for (int i = num; i < size(); i++)
+    {
+        if (life[i] > 0)
+        {
+            --particles_alive;
+        }
+    }
+
+    center.resize(center_per_particle * num);
+    radius.resize(radius_per_particle * num);
+    color.resize(color_per_particle * num);
+
+    life.resize(num, -1);
+    fade.resize(num);
+    base_radius.resize(num);
+    speed_x.resize(num);
+    speed_y.resize(num);
+    g_x.resize(num);
+    g_y.resize(num);
+    start_x.resize(num);
+}
+
+int ParticleArrays::size() const
+{
+    return life.size();
+}
+
+int ParticleArrays::alive() const
+{
+    return particles_alive;
+}
+
+int ParticleArrays::update_range(int begin, int end)
+{
+    const float slowdown = 0.8;
+
+    float *__restrict pos   = center.data();
+    float *__restrict rgba  = color.data();
+    float *__restrict r     = radius.data();
+    float *__restrict l     = life.data();
+    float *__restrict sx    = speed_x.data();
+    float *__restrict sy    = speed_y.data();
+    float *__restrict gx    = g_x.data();
+    const float *__restrict gy    = g_y.data();
+    const float *__restrict f     = fade.data();
+    const float *__restrict base  = base_radius.data();
+    const float *__restrict start = start_x.data();
+
+    /* Dead particles are left untouched. The loop has no branches, so that
+     * the compiler can vectorize it. */
+    int died = 0;
+#   pragma omp simd reduction(+:died)
+    for (int i = begin; i < end; i++)
+    {
+        const bool was_alive = l[i] > 0;
+
+        float x = pos[2 * i] + sx[i] * 0.2f * slowdown;
+        float y = pos[2 * i + 1] + sy[i] * 0.2f * slowdown;
+        const float new_sx = sx[i] + gx[i] * 0.3f * slowdown;
+        const float new_sy = sy[i] + gy[i] * 0.3f * slowdown;
+
+        /* computed in double precision, so particles die exactly when they
+         * used to */
+        const float new_life  = l[i] - f[i] * 0.3 * slowdown;
+        const float new_alpha = rgba[4 * i + 3] / l[i] * new_life;
+        const float new_r     = base[i] * std::sqrt(std::max(new_life, 0.0f));
+        const float new_gx    = (start[i] < x) ? -1.0f : 1.0f;
+
+        const bool dies = new_life <= 0;
+        if (dies)
+        {
+            /* move outside */
+            x = y = -10000;
+        }
+
+        pos[2 * i]      = was_alive ? x : pos[2 * i];
+        pos[2 * i + 1]  = was_alive ? y : pos[2 * i + 1];
+        sx[i]           = was_alive ? new_sx : sx[i];
+        sy[i]           = was_alive ? new_sy : sy[i];
+        gx[i]           = was_alive ? new_gx : gx[i];
+        l[i]            = was_alive ? new_life : l[i];
+        r[i]            = was_alive ? new_r : r[i];
+        rgba[4 * i + 3] = was_alive ? new_alpha : rgba[4 * i + 3];
+        died += (was_alive && dies);
+    }
+
+    return died;
+}
+
+void ParticleArrays::update()
+{
+    const int n = size();
+    const int chunks = (n + particles_per_thread - 1) / particles_per_thread;
+    int died = 0;
+
+#ifdef _OPENMP
+    const int threads = std::clamp(chunks, 1, omp_get_max_threads());
+#   pragma omp parallel for num_threads(threads) if (threads > 1) reduction(+:died) schedule(static)
+#endif
+    for (int c = 0; c < chunks; c++)
+    {
+        died += update_range(c * particles_per_thread, std::min(n, (c + 1) * particles_per_thread));
+    }
+
+    particles_alive -= died;
+}
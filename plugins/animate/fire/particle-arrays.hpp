@@ -0,0 +1,84 @@
+#ifndef ANIMATION_FIRE_PARTICLE_ARRAYS_HPP
+#define ANIMATION_FIRE_PARTICLE_ARRAYS_HPP
+
+#include <glm/glm.hpp>
+#include <functional>
+#include <vector>
+
+/* the initial state of a particle */
+struct Particle
+{
+    float life = -1;
+    float fade;
+
+    float radius, base_radius;
+
+    glm::vec2 pos{0.0, 0.0}, speed{0.0, 0.0}, g{0.0, 0.0};
+    glm::vec2 start_pos;
+
+    glm::vec4 color{1.0, 1.0, 1.0, 1.0};
+};
+
+/* a function to initialize a particle */
+using ParticleIniter = std::function<void (Particle&)>;
+
+/* The state of all particles of a particle system, stored as a structure of
+ * arrays, so that the update loop can be vectorized.
+ *
+ * The center, radius and color arrays have exactly the layout of the vertex
+ * attributes of the particle shader, so they can be uploaded to the GPU as
+ * they are. This class does not use OpenGL, the rendering is done by the
+ * ParticleSystem. */
+class ParticleArrays
+{
+  public:
+    static constexpr int color_per_particle  = 4;
+    static constexpr int radius_per_particle = 1;
+    static constexpr int center_per_particle = 2;
+
+    /* Below this many particles per thread, the particles are updated on the
+     * calling thread only, because waking up the OpenMP threads costs more
+     * than the update itself. */
+    static constexpr int particles_per_thread = 16384;
+
+    /* vertex attributes */
+    std::vector<float> center;
+    std::vector<float> radius;
+    std::vector<float> color;
+
+    /* the rest of the particle state */
+    std::vector<float> life;
+    std::vector<float> fade;
+    std::vector<float> base_radius;
+    std::vector<float> speed_x, speed_y;
+    std::vector<float> g_x, g_y;
+    std::vector<float> start_x;
+
+    /* spawn at most num new particles, initialized with init.
+     * returns the number of actually spawned particles */
+    int spawn(int num, const ParticleIniter& init);
+
+    /* change the maximal number of particles, killing the particles whose
+     * index is not smaller than num */
+    void resize(int num);
+
+    // return the maximal number of particles
+    int size() const;
+
+    // number of particles alive
+    int alive() const;
+
+    /* update all particles, in parallel if OpenMP is enabled and there are
+     * enough particles */
+    void update();
+
+  private:
+    int particles_alive = 0;
+
+    /* update the particles with index in [begin, end) on the calling thread.
+     * Returns the number of particles which died. */
+    int update_range(int begin, int end);
+    void set(int i, const Particle& p);
+};
+
+#endif /* end of include guard: ANIMATION_FIRE_PARTICLE_ARRAYS_HPP */
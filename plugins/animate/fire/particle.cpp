@@ -2,49 +2,10 @@
 #include "shaders.hpp"
 #include <wayfire/core.hpp>
 
-void Particle::update(float time)
+ParticleSystem::ParticleSystem(int num_part)
 {
-    if (life <= 0) // ignore
-    {
-        return;
-    }
-
-    const float slowdown = 0.8;
-
-    pos   += speed * 0.2f * slowdown;
-    speed += g * 0.3f * slowdown;
-
-    if (life != 0)
-    {
-        color.a /= life;
-    }
-
-    life    -= fade * 0.3 * slowdown;
-    radius   = base_radius * std::pow(life, 0.5);
-    color.a *= life;
-
-    if (start_pos.x < pos.x)
-    {
-        g.x = -1;
-    } else
-    {
-        g.x = 1;
-    }
-
-    if (life <= 0)
-    {
-        /* move outside */
-        pos = {-10000, -10000};
-    }
-}
-
-ParticleSystem::ParticleSystem(int particles)
-{
-    resize(particles);
-    last_update_msec = wf::get_current_time();
+    resize(num_part);
     create_program();
-
-    particles_alive.store(0);
 }
 
 void ParticleSystem::set_initer(ParticleIniter init)
@@ -62,93 +23,27 @@ ParticleSystem::~ParticleSystem()
 
 int ParticleSystem::spawn(int num)
 {
-    std::atomic<int> spawned(0);
-
-#   pragma omp parallel for
-    for (size_t i = 0; i < ps.size(); i++)
-    {
-        if ((ps[i].life <= 0) && (spawned < num))
-        {
-            pinit_func(ps[i]);
-            ++spawned;
-            ++particles_alive;
-        }
-    }
-
-    return spawned;
+    return particles.spawn(num, pinit_func);
 }
 
 void ParticleSystem::resize(int num)
 {
-    if (num == (int)ps.size())
-    {
-        return;
-    }
-
-#   pragma omp parallel for
-    for (size_t i = num; i < ps.size(); i++)
-    {
-        if (ps[i].life >= 0)
-        {
-            --particles_alive;
-        }
-    }
-
-    ps.resize(num);
-
-    color.resize(color_per_particle * num);
-    dark_color.resize(color_per_particle * num);
-    radius.resize(radius_per_particle * num);
-    center.resize(center_per_particle * num);
+    particles.resize(num);
 }
 
 int ParticleSystem::size()
 {
-    return ps.size();
-}
-
-void ParticleSystem::update_worker(float time, int i)
-{
-    if (ps[i].life <= 0)
-    {
-        return;
-    }
-
-    ps[i].update(time);
-
-    if (ps[i].life <= 0)
-    {
-        --particles_alive;
-    }
-
-    for (int j = 0; j < 4; j++) // maybe use memcpy?
-    {
-        color[4 * i + j] = ps[i].color[j];
-        dark_color[4 * i + j] = ps[i].color[j] * 0.5;
-    }
-
-    center[2 * i]     = ps[i].pos[0];
-    center[2 * i + 1] = ps[i].pos[1];
-
-    radius[i] = ps[i].radius;
+    return particles.size();
 }
 
 void ParticleSystem::update()
 {
-    // FIXME: don't hardcode 60FPS
-    float time = (wf::get_current_time() - last_update_msec) / 16.0;
-    last_update_msec = wf::get_current_time();
-
-#   pragma omp parallel for
-    for (size_t i = 0; i < ps.size(); i++)
-    {
-        update_worker(time, i);
-    }
+    particles.update();
 }
 
 int ParticleSystem::statistic()
 {
-    return particles_alive;
+    return particles.alive();
 }
 
 void ParticleSystem::create_program()
@@ -173,31 +68,34 @@ void ParticleSystem::render(glm::mat4 matrix)
     program.attrib_pointer("position", 2, 0, vertex_data);
     program.attrib_divisor("position", 0);
 
-    program.attrib_pointer("radius", 1, 0, radius.data());
+    /* The particle arrays are laid out as the shader expects them */
+    program.attrib_pointer("radius", ParticleArrays::radius_per_particle, 0, particles.radius.data());
     program.attrib_divisor("radius", 1);
 
-    program.attrib_pointer("center", 2, 0, center.data());
+    program.attrib_pointer("center", ParticleArrays::center_per_particle, 0, particles.center.data());
     program.attrib_divisor("center", 1);
 
+    program.attrib_pointer("color", ParticleArrays::color_per_particle, 0, particles.color.data());
+    program.attrib_divisor("color", 1);
+
     // matrix
     program.uniformMatrix4f("matrix", matrix);
 
     /* Darken the background */
-    program.attrib_pointer("color", 4, 0, dark_color.data());
-    program.attrib_divisor("color", 1);
+    program.uniform1f("color_scale", 0.5);
 
     GL_CALL(glEnable(GL_BLEND));
     GL_CALL(glBlendFunc(GL_ZERO, GL_ONE_MINUS_SRC_ALPHA));
     program.uniform1f("smoothing", 0.7);
 
     // TODO: optimize shaders for this case
-    GL_CALL(glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, ps.size()));
+    GL_CALL(glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, particles.size()));
 
     // particle color
-    program.attrib_pointer("color", 4, 0, color.data());
+    program.uniform1f("color_scale", 1.0);
     GL_CALL(glBlendFunc(GL_SRC_ALPHA, GL_ONE));
     program.uniform1f("smoothing", 0.5);
-    GL_CALL(glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, ps.size()));
+    GL_CALL(glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, 4, particles.size()));
 
     GL_CALL(glDisable(GL_BLEND));
     GL_CALL(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
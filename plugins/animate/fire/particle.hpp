@@ -2,30 +2,7 @@
 #define ANIMATION_FIRE_PARTICLE_HPP
 
 #include <wayfire/opengl.hpp>
-#include <functional>
-#include <atomic>
-#include <vector>
-
-struct Particle
-{
-    float life = -1;
-    float fade;
-
-    float radius, base_radius;
-
-    glm::vec2 pos{0.0, 0.0}, speed{0.0, 0.0}, g{0.0, 0.0};
-    glm::vec2 start_pos;
-
-    glm::vec4 color{1.0, 1.0, 1.0, 1.0};
-
-    /* update the given particle
-     * time is the percentage of the frame which has elapsed
-     * must be thread-safe */
-    void update(float time);
-};
-
-/* a function to initialize a particle */
-using ParticleIniter = std::function<void (Particle&)>;
+#include "particle-arrays.hpp"
 
 class ParticleSystem
 {
@@ -67,22 +44,9 @@ class ParticleSystem
     ParticleSystem() = delete;
 
     ParticleIniter pinit_func = [] (auto) {};
-    uint32_t last_update_msec;
-
-    std::atomic<int> particles_alive;
-    std::vector<Particle> ps;
-
-    static constexpr int color_per_particle = 4;
-    std::vector<float> color, dark_color;
-
-    static constexpr int radius_per_particle = 1;
-    std::vector<float> radius;
-
-    static constexpr int center_per_particle = 2;
-    std::vector<float> center;
+    ParticleArrays particles;
 
     OpenGL::program_t program;
-    void update_worker(float time, int i);
     void create_program();
 };
 
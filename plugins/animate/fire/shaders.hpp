@@ -11,6 +11,7 @@ attribute highp vec2 center;
 attribute highp vec4 color;
 
 uniform mat4 matrix;
+uniform highp float color_scale;
 
 varying highp vec2 uv;
 varying highp vec4 out_color;
@@ -21,7 +22,7 @@ void main() {
     gl_Position = matrix * vec4(center.x + uv.x * 0.75, center.y + uv.y, 0.0, 1.0);
 
     R = radius;
-    out_color = color;
+    out_color = color * color_scale;
 }
 )";
 
@@ -155,7 +155,12 @@ wlr_box wf_blur_base::copy_region(wf::auxilliary_buffer_t& result,
 {
     auto subbox = source.framebuffer_box_from_geometry_box(
         wlr_box_from_pixman_box(region.get_extents()));
+    return copy_framebuffer_box(result, source, subbox);
+}
 
+wlr_box wf_blur_base::copy_framebuffer_box(wf::auxilliary_buffer_t& result,
+    const wf::render_target_t& source, wlr_box subbox)
+{
     auto source_box =
         source.framebuffer_box_from_geometry_box(source.geometry);
 
@@ -180,25 +185,15 @@ wlr_box wf_blur_base::copy_region(wf::auxilliary_buffer_t& result,
     return subbox;
 }
 
-void wf_blur_base::prepare_blur(const wf::render_target_t& target_fb, const wf::region_t& damage)
+void wf_blur_base::blur_framebuffer_region(const wf::render_target_t& source, const wf::region_t& fb_region)
 {
-    if (damage.empty())
-    {
-        return;
-    }
-
     int degrade     = degrade_opt;
-    auto damage_box = copy_region(fb[0], target_fb, damage);
+    auto damage_box = copy_framebuffer_box(fb[0], source, wlr_box_from_pixman_box(fb_region.get_extents()));
 
     /* As an optimization, we create a region that blur can use
      * to perform minimal rendering required to blur. We start
      * by translating the input damage region */
-    wf::region_t blur_damage;
-    for (auto b : damage)
-    {
-        blur_damage |= target_fb.framebuffer_box_from_geometry_box(
-            wlr_box_from_pixman_box(b));
-    }
+    wf::region_t blur_damage = fb_region;
 
     /* Scale and translate the region */
     blur_damage += -wf::point_t{damage_box.x, damage_box.y};
@@ -212,7 +207,199 @@ void wf_blur_base::prepare_blur(const wf::render_target_t& target_fb, const wf::
         std::swap(fb[0], fb[1]);
     }
 
-    prepared_geometry = damage_box;
+    prepared_geometry   = damage_box;
+    prepared_background = &fb[0];
+    ++blur_generation;
+}
+
+void wf_blur_base::prepare_blur(const wf::render_target_t& target_fb, const wf::region_t& damage)
+{
+    if (damage.empty())
+    {
+        return;
+    }
+
+    wf::region_t fb_damage;
+    for (auto b : damage)
+    {
+        fb_damage |= target_fb.framebuffer_box_from_geometry_box(wlr_box_from_pixman_box(b));
+    }
+
+    blur_framebuffer_region(target_fb, fb_damage);
+}
+
+static uint64_t region_area(const wf::region_t& region)
+{
+    uint64_t area = 0;
+    for (const auto& b : region)
+    {
+        area += uint64_t(b.x2 - b.x1) * uint64_t(b.y2 - b.y1);
+    }
+
+    return area;
+}
+
+void wf_blur_cache_t::invalidate(wf::region_t region, int blur_radius)
+{
+    if (valid.empty())
+    {
+        return;
+    }
+
+    // Every blurred pixel depends on the background pixels up to blur_radius away.
+    region.expand_edges(blur_radius);
+    valid ^= region;
+}
+
+/**
+ * Calculate which parts of the request damage have to be blurred, and reset the
+ * cache if the view has moved. The parts which get new blurred pixels are stored
+ * in request.to_blur.
+ *
+ * @return The region which has to be blurred for that, i.e. request.to_blur padded
+ *   by the blur radius, because the blurred pixels at its edges depend on the
+ *   background around it.
+ */
+static wf::region_t find_region_to_blur(wf_blur_request_t& request, int degrade, int blur_radius,
+    wf_blur_cache_statistics_t& stats)
+{
+    wf::region_t needed;
+    for (auto b : request.damage)
+    {
+        needed |= request.target.framebuffer_box_from_geometry_box(wlr_box_from_pixman_box(b));
+    }
+
+    if (!request.cache)
+    {
+        // The damage was already padded by the render instance, which restores
+        // the pixels at its edges after rendering.
+        request.to_blur = needed;
+        return needed;
+    }
+
+    auto& cache     = *request.cache;
+    auto source_box = request.target.framebuffer_box_from_geometry_box(request.target.geometry);
+    auto cache_box  = sanitize(request.target.framebuffer_box_from_geometry_box(request.blur_box),
+        degrade, source_box);
+
+    if ((cache.box != cache_box) || (cache.degrade != degrade))
+    {
+        cache.box     = cache_box;
+        cache.degrade = degrade;
+        cache.valid.clear();
+        cache.buffer.allocate({std::max(1, cache_box.width / degrade), std::max(1, cache_box.height / degrade)});
+    }
+
+    needed &= cache_box;
+
+    // Blur only the parts which are not in the cache, aligned so that they map to
+    // whole pixels of the degraded buffers.
+    wf::region_t stale;
+    for (auto b : needed ^ cache.valid)
+    {
+        stale |= sanitize(wlr_box_from_pixman_box(b), degrade, cache_box);
+    }
+
+    const uint64_t needed_area = region_area(needed);
+    const uint64_t stale_area  = region_area(needed & stale);
+    stats.reused_pixels  += needed_area - stale_area;
+    stats.blurred_pixels += stale_area;
+    if (!stale.empty())
+    {
+        stats.misses++;
+    } else if (needed_area > 0)
+    {
+        stats.hits++;
+    }
+
+    request.to_blur = stale;
+
+    // Only the interior of the padded region is blurred correctly, so only the
+    // stale region is written back to the cache.
+    wf::region_t expanded = stale;
+    expanded.expand_edges(blur_radius);
+
+    wf::region_t padded;
+    for (auto b : expanded)
+    {
+        padded |= sanitize(wlr_box_from_pixman_box(b), degrade, source_box);
+    }
+
+    return padded;
+}
+
+void wf_blur_base::prepare_blur_batch(const std::vector<wf_blur_request_t*>& requests)
+{
+    if (requests.empty())
+    {
+        return;
+    }
+
+    const int degrade     = degrade_opt;
+    const int blur_radius = calculate_blur_radius();
+    wf::region_t to_blur;
+    for (auto& request : requests)
+    {
+        to_blur |= find_region_to_blur(*request, degrade, blur_radius, cache_statistics);
+    }
+
+    if (!to_blur.empty())
+    {
+        blur_framebuffer_region(requests.front()->target, to_blur);
+    }
+
+    for (auto& request : requests)
+    {
+        if (!request->cache)
+        {
+            request->result = &fb[0];
+            request->result_geometry   = prepared_geometry;
+            request->result_generation = blur_generation;
+            continue;
+        }
+
+        auto& cache = *request->cache;
+        if (!request->to_blur.empty())
+        {
+            GLuint src_fb = wf::gles::ensure_render_buffer_fb_id(fb[0].get_renderbuffer());
+            GLuint dst_fb = wf::gles::ensure_render_buffer_fb_id(cache.buffer.get_renderbuffer());
+            GL_CALL(glBindFramebuffer(GL_READ_FRAMEBUFFER, src_fb));
+            GL_CALL(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst_fb));
+
+            /* Copy the newly blurred pixels into the cache */
+            for (const auto& b : request->to_blur)
+            {
+                const int width  = (b.x2 - b.x1) / degrade;
+                const int height = (b.y2 - b.y1) / degrade;
+                const int src_x  = (b.x1 - prepared_geometry.x) / degrade;
+                const int src_y  = (b.y1 - prepared_geometry.y) / degrade;
+                const int dst_x  = (b.x1 - cache.box.x) / degrade;
+                const int dst_y  = (b.y1 - cache.box.y) / degrade;
+                GL_CALL(glBlitFramebuffer(
+                    src_x, src_y, src_x + width, src_y + height,
+                    dst_x, dst_y, dst_x + width, dst_y + height,
+                    GL_COLOR_BUFFER_BIT, GL_NEAREST));
+            }
+
+            cache.valid |= request->to_blur;
+        }
+
+        request->result = &cache.buffer;
+        request->result_geometry = cache.box;
+    }
+}
+
+bool wf_blur_base::use_prepared_blur(const wf_blur_request_t& request)
+{
+    if (!request.result ||
+        (!request.cache && (request.result_generation != blur_generation)))
+    {
+        return false;
+    }
+
+    prepared_background = request.result;
+    prepared_geometry   = request.result_geometry;
+    return true;
 }
 
 static wf::pointf_t get_center(wf::geometry_t g)
@@ -223,7 +410,7 @@ static wf::pointf_t get_center(wf::geometry_t g)
 void wf_blur_base::render(wf::gles_texture_t src_tex, wlr_box src_box, const wf::region_t& damage,
     const wf::render_target_t& background_source_fb, const wf::render_target_t& target_fb)
 {
-    wf::gles_texture_t blurred_background = wf::gles_texture_t::from_aux(fb[0]);
+    wf::gles_texture_t blurred_background = wf::gles_texture_t::from_aux(*prepared_background);
     wf::gles::ensure_render_buffer_fb_id(target_fb);
     blend_program.use(src_tex.type);
 
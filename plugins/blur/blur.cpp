@@ -1,5 +1,6 @@
 #include <wayfire/per-output-plugin.hpp>
 #include <memory>
+#include <algorithm>
 #include <list>
 #include <wayfire/config/types.hpp>
 #include <wayfire/plugin.hpp>
@@ -21,6 +22,8 @@
 #include "wayfire/scene-render.hpp"
 #include "wayfire/scene.hpp"
 #include "wayfire/signal-provider.hpp"
+#include "wayfire/plugins/common/shared-core-data.hpp"
+#include "wayfire/plugins/ipc/ipc-method-repository.hpp"
 #include <list>
 
 using blur_algorithm_provider =
@@ -90,12 +93,189 @@ class blur_node_t : public transformer_base_node_t
     }
 };
 
+class blur_render_instance_t;
+
+/**
+ * A group of blur render instances from the same render pass whose backgrounds
+ * are blurred together, when the first of them is rendered. For this to work,
+ * nothing rendered between the first and the last instance of the batch (the
+ * instances themselves included) may draw over the areas from which the other
+ * instances sample their background.
+ */
+struct blur_batch_t
+{
+    // The instruction list of the render pass the batch belongs to.
+    const std::vector<render_instruction_t> *instructions = nullptr;
+    wlr_buffer *buffer = nullptr;
+    // The areas the instances sample from, in framebuffer coordinates.
+    wf::region_t samples;
+    std::vector<blur_render_instance_t*> instances;
+    bool prepared = false;
+};
+
 class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
 {
     blur_node_t::saved_pixels_t *saved_pixels = nullptr;
 
+    std::shared_ptr<blur_batch_t> batch;
+    wf_blur_request_t request;
+    wf::region_t scheduled_repaint;
+
+    // The blurred background from previous frames, and the part of the current
+    // damage whose background is rendered fresh by the nodes below.
+    wf_blur_cache_t cache;
+    wf::region_t cacheable_damage;
+    bool forwarding_own_damage = false;
+
+    // Damage coming from anywhere but the view itself may have changed the
+    // background, so the blurred pixels depending on it have to be recomputed.
+    wf::signal::connection_t<wf::output_damage_signal> on_output_damage =
+        [=] (wf::output_damage_signal *ev)
+    {
+        if (!forwarding_own_damage)
+        {
+            cache.invalidate(ev->region, self->provider()->calculate_blur_radius());
+        }
+    };
+
+    bool can_use_cache(const wf::scene::render_instruction_t& data)
+    {
+        // The cache is invalidated with damage in the output's framebuffer
+        // coordinates, so it works only when rendering directly to the output.
+        return _shown_on && (data.pass == _shown_on->render->get_current_pass()) &&
+               (data.target.get_buffer() == _shown_on->render->get_target_framebuffer().get_buffer());
+    }
+
   public:
-    using transformer_render_instance_t::transformer_render_instance_t;
+    blur_render_instance_t(blur_node_t *self, damage_callback push_damage, wf::output_t *shown_on) :
+        transformer_render_instance_t(self, push_damage, shown_on)
+    {
+        this->_push_damage = [=] (const wf::region_t& region)
+        {
+            forwarding_own_damage = true;
+            push_damage(region);
+            forwarding_own_damage = false;
+        };
+
+        if (shown_on)
+        {
+            shown_on->connect(&on_output_damage);
+        }
+    }
+
+    ~blur_render_instance_t()
+    {
+        leave_batch();
+    }
+
+    void leave_batch()
+    {
+        if (batch)
+        {
+            auto& instances = batch->instances;
+            instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+            batch = nullptr;
+        }
+    }
+
+    /**
+     * Find the batch which a blur instance scheduled now may join, i.e. the batch
+     * of the closest blur instance scheduled before in the same render pass.
+     * Instructions are scheduled front to back, so the batch grows downwards in
+     * the stacking order. Since the batch is found via the instructions of the
+     * pass, it can never be shared with other passes.
+     *
+     * @return The batch and the index of its last instruction.
+     */
+    static std::pair<std::shared_ptr<blur_batch_t>, size_t> find_open_batch(
+        const std::vector<render_instruction_t>& instructions)
+    {
+        for (size_t i = instructions.size(); i-- > 0;)
+        {
+            if (auto other = dynamic_cast<blur_render_instance_t*>(instructions[i].instance))
+            {
+                auto& open = other->batch;
+                if (open && !open->prepared && (open->instructions == &instructions))
+                {
+                    return {open, i};
+                }
+
+                break;
+            }
+        }
+
+        return {nullptr, 0};
+    }
+
+    void join_batch(const std::vector<render_instruction_t>& instructions,
+        const wf::render_target_t& target, const wf::region_t& padded_region)
+    {
+        // We sample from and draw over (when restoring saved pixels) the same area.
+        auto samples = target.framebuffer_region_from_geometry_region(padded_region);
+        auto [open, last_instruction] = find_open_batch(instructions);
+        if (open && (open->buffer == target.get_buffer()))
+        {
+            wf::region_t drawn = samples;
+            for (size_t i = last_instruction + 1; i < instructions.size(); i++)
+            {
+                auto& instr = instructions[i];
+                drawn |= instr.target.framebuffer_region_from_geometry_region(instr.damage);
+            }
+
+            if ((drawn & open->samples).empty())
+            {
+                batch = open;
+            }
+        }
+
+        if (!batch)
+        {
+            batch = std::make_shared<blur_batch_t>();
+            batch->instructions = &instructions;
+            batch->buffer = target.get_buffer();
+        }
+
+        batch->samples |= samples;
+        batch->instances.push_back(this);
+    }
+
+    wf_blur_request_t *fill_request(bool use_cache)
+    {
+        request.damage =
+            calculate_translucent_damage(request.target, use_cache ? cacheable_damage : scheduled_repaint);
+        request.blur_box = self->get_bounding_box();
+        request.cache    = use_cache ? &cache : nullptr;
+        request.result   = nullptr;
+        return &request;
+    }
+
+    void prepare_background(const wf::scene::render_instruction_t& data)
+    {
+        auto provider = self->provider();
+        if (batch && !batch->prepared)
+        {
+            batch->prepared = true;
+            const bool use_cache = can_use_cache(data);
+
+            std::vector<wf_blur_request_t*> requests;
+            for (auto& instance : batch->instances)
+            {
+                requests.push_back(instance->fill_request(use_cache));
+            }
+
+            provider->prepare_blur_batch(requests);
+        }
+
+        if (batch && provider->use_prepared_blur(request))
+        {
+            return;
+        }
+
+        // Not batched, or another blur has overwritten the batch result since.
+        provider->prepare_blur_batch({fill_request(can_use_cache(data))});
+        provider->use_prepared_blur(request);
+    }
+
     bool is_fully_opaque(wf::region_t damage)
     {
         if (self->get_children().size() == 1)
@@ -133,6 +313,7 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
     {
         const int padding = calculate_damage_padding(target, self->provider()->calculate_blur_radius());
         auto bbox = self->get_bounding_box();
+        leave_batch();
 
         // In order to render a part of the blurred background, we need to sample
         // from area which is larger than the damaged area. However, the edges
@@ -165,6 +346,9 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
 
         // Actual region which will be repainted by this render instance.
         wf::region_t we_repaint = padded_region;
+        cacheable_damage  = damage & bbox;
+        scheduled_repaint = we_repaint;
+        request.target    = target;
 
         this->saved_pixels   = self->acquire_saved_pixel_buffer();
         saved_pixels->region =
@@ -195,6 +379,7 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
             }
         });
 
+        join_batch(instructions, target, padded_region);
         instructions.push_back(render_instruction_t{
                     .instance = this,
                     .target   = target,
@@ -210,8 +395,7 @@ class blur_render_instance_t : public transformer_render_instance_t<blur_node_t>
             auto tex = wf::gles_texture_t{get_texture(data.target.scale)};
             if (!data.damage.empty())
             {
-                auto translucent_damage = calculate_translucent_damage(data.target, data.damage);
-                self->provider()->prepare_blur(data.target, translucent_damage);
+                prepare_background(data);
                 self->provider()->render(tex, bounding_box, data.damage, data.target, data.target);
             }
 
@@ -299,6 +483,26 @@ class wayfire_blur : public wf::plugin_interface_t
     wf::option_wrapper_t<wf::buttonbinding_t> toggle_button{"blur/toggle"};
     wf::config::option_base_t::updated_callback_t blur_method_changed;
     std::unique_ptr<wf_blur_base> blur_algorithm;
+    wf::shared_data::ref_ptr_t<wf::ipc::method_repository_t> ipc_repo;
+
+    wf::ipc::method_callback ipc_get_cache_stats = [=] (wf::json_t) -> wf::json_t
+    {
+        if (!blur_algorithm)
+        {
+            return wf::ipc::json_error("blur is not active");
+        }
+
+        const auto& stats = blur_algorithm->get_cache_statistics();
+        const uint64_t total_pixels = stats.reused_pixels + stats.blurred_pixels;
+
+        auto response = wf::ipc::json_ok();
+        response["hits"]   = stats.hits;
+        response["misses"] = stats.misses;
+        response["reused-pixels"]  = stats.reused_pixels;
+        response["blurred-pixels"] = stats.blurred_pixels;
+        response["hit-rate"] = total_pixels ? (1.0 * stats.reused_pixels / total_pixels) : 0.0;
+        return response;
+    };
 
     void add_transformer(wayfire_view view)
     {
@@ -325,7 +529,7 @@ class wayfire_blur : public wf::plugin_interface_t
 
     void remove_transformers()
     {
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             pop_transformer(view);
         }
@@ -343,6 +547,7 @@ class wayfire_blur : public wf::plugin_interface_t
         }
 
         wf::get_core().connect(&on_render_pass_begin);
+        ipc_repo->register_method("wf/blur/get-cache-stats", ipc_get_cache_stats);
         blur_method_changed = [=] ()
         {
             blur_algorithm = create_blur_from_name(method_opt);
@@ -377,7 +582,7 @@ class wayfire_blur : public wf::plugin_interface_t
         provider = [=] () { return this->blur_algorithm.get(); };
         wf::get_core().connect(&on_view_mapped);
 
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             if (blur_by_default.matches(view))
             {
@@ -390,6 +595,7 @@ class wayfire_blur : public wf::plugin_interface_t
     {
         remove_transformers();
         wf::get_core().bindings->rem_binding(&button_toggle);
+        ipc_repo->unregister_method("wf/blur/get-cache-stats");
 
         /* Call blur algorithm destructor */
         blur_algorithm = nullptr;
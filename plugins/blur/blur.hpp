@@ -4,6 +4,7 @@
 #include <wayfire/opengl.hpp>
 #include <wayfire/render-manager.hpp>
 #include <wayfire/region.hpp>
+#include <vector>
 
 /* The MIT License (MIT)
  *
@@ -88,6 +89,68 @@
  * `````````````````````````````````````````````````````````````````
  */
 
+/**
+ * The blurred background behind a single view on a single output, kept across
+ * frames so that it only has to be recomputed where the background changed.
+ * All coordinates are in framebuffer coordinates of the output.
+ */
+struct wf_blur_cache_t
+{
+    /* the blurred background, in the degraded resolution */
+    wf::auxilliary_buffer_t buffer;
+    /* the framebuffer box covered by buffer */
+    wf::geometry_t box = {0, 0, 0, 0};
+    /* the degrade factor used for buffer */
+    int degrade = 0;
+    /* the parts of box where buffer is up to date */
+    wf::region_t valid;
+
+    /**
+     * Mark the blurred pixels which depend on the background in @region as stale.
+     *
+     * @param region The damaged background, in framebuffer coordinates.
+     * @param blur_radius The blur radius, as returned by calculate_blur_radius().
+     */
+    void invalidate(wf::region_t region, int blur_radius);
+};
+
+/* Accumulated statistics about the usage of wf_blur_cache_t */
+struct wf_blur_cache_statistics_t
+{
+    /* number of times the blurred background was fully taken from the cache */
+    uint64_t hits = 0;
+    /* number of times at least a part of the background had to be blurred */
+    uint64_t misses = 0;
+    /* number of framebuffer pixels taken from the cache */
+    uint64_t reused_pixels = 0;
+    /* number of framebuffer pixels which were blurred */
+    uint64_t blurred_pixels = 0;
+};
+
+/**
+ * A request to blur the background of a single view, see
+ * wf_blur_base::prepare_blur_batch().
+ */
+struct wf_blur_request_t
+{
+    /* the render target which the damage and blur_box are relative to */
+    wf::render_target_t target;
+    /* the region to be blurred, in logical coordinates */
+    wf::region_t damage;
+    /* the whole area which can be blurred, i.e. the bounding box of the view */
+    wf::geometry_t blur_box;
+    /* if set, the blurred pixels in the cache are reused where valid, and the
+     * newly blurred pixels are stored there */
+    wf_blur_cache_t *cache = nullptr;
+
+    /* the parts of the damage which get new blurred pixels, in framebuffer coords */
+    wf::region_t to_blur;
+    /* the buffer and framebuffer box containing the result */
+    wf::auxilliary_buffer_t *result = nullptr;
+    wf::geometry_t result_geometry = {0, 0, 0, 0};
+    uint64_t result_generation     = 0;
+};
+
 class wf_blur_base
 {
   protected:
@@ -95,6 +158,12 @@ class wf_blur_base
      * destructor */
     wf::auxilliary_buffer_t fb[2];
     wf::geometry_t prepared_geometry;
+    /* the buffer containing the blurred background for render(), either fb[0]
+     * or the buffer of a wf_blur_cache_t */
+    wf::auxilliary_buffer_t *prepared_background = &fb[0];
+    wf_blur_cache_statistics_t cache_statistics;
+    /* incremented every time fb[0] is overwritten */
+    uint64_t blur_generation = 0;
 
     /* the program created by the given algorithm, cleaned up in base destructor */
     OpenGL::program_t program[2];
@@ -122,6 +191,14 @@ class wf_blur_base
     wlr_box copy_region(wf::auxilliary_buffer_t& result,
         const wf::render_target_t& source, const wf::region_t& region);
 
+    /* copy the source pixels from the given box in framebuffer coords, storing
+     * into result. returns the actually copied box, aligned for degrading */
+    wlr_box copy_framebuffer_box(wf::auxilliary_buffer_t& result,
+        const wf::render_target_t& source, wlr_box subbox);
+
+    /* blur the pixels of source in fb_region (framebuffer coords) into fb[0] */
+    void blur_framebuffer_region(const wf::render_target_t& source, const wf::region_t& fb_region);
+
     /* blur fb[0]
      * width and height are the scaled dimensions of the buffer
      * returns the index of the fb where the result is stored (0 or 1) */
@@ -141,6 +218,31 @@ class wf_blur_base
      */
     void prepare_blur(const wf::render_target_t& target_fb, const wf::region_t& damage);
 
+    /**
+     * Calculate the blurred background of several views at once, using a single
+     * downsample and blur pass over the union of their regions.
+     *
+     * The background of each view must be fully rendered in the target
+     * framebuffer at this point, so the views should not overlap each other.
+     * Afterwards, call use_prepared_blur() with each request before render().
+     *
+     * @param requests The requests to prepare, all rendered to the same buffer.
+     */
+    void prepare_blur_batch(const std::vector<wf_blur_request_t*>& requests);
+
+    /**
+     * Make render() use the blurred background prepared for @request.
+     *
+     * @return false if the prepared background has since been overwritten by
+     *   another blur, in which case the request has to be prepared again.
+     */
+    bool use_prepared_blur(const wf_blur_request_t& request);
+
+    const wf_blur_cache_statistics_t& get_cache_statistics() const
+    {
+        return cache_statistics;
+    }
+
     /**
      * Render a view with a blended background as prepared from @prepare_blur.
      *
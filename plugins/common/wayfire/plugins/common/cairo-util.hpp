@@ -9,6 +9,11 @@
 #include <pango/pangocairo.h>
 #include <wayfire/dassert.hpp>
 #include <wayfire/render.hpp>
+#include <wayfire/plugins/common/shared-core-data.hpp>
+#include <functional>
+#include <list>
+#include <memory>
+#include <unordered_map>
 
 // TODO: do we need some kind of dependency here?
 #include <drm_fourcc.h>
@@ -112,6 +117,147 @@ struct owned_texture_t
     wf::dimensions_t size = {0, 0};
 };
 
+/**
+ * The parameters with which a text texture was rendered, used to find it in the
+ * text_texture_cache_t.
+ */
+struct text_texture_key_t
+{
+    std::string text;
+    std::string font;
+    double font_size = 0;
+    wf::color_t text_color = {0, 0, 0, 0};
+    wf::color_t bg_color   = {0, 0, 0, 0};
+    float scale = 1.0;
+    /* a size constraint of the texture, if the renderer has one */
+    wf::dimensions_t size = {0, 0};
+    /* the size of the surface the text is rendered on, if it is not
+     * determined by the other parameters */
+    wf::dimensions_t surface_size = {0, 0};
+    /* any other options; they should also identify the renderer, so that
+     * textures from different renderers are never mixed up */
+    uint32_t flags = 0;
+
+    bool operator ==(const text_texture_key_t& other) const
+    {
+        auto same_color = [] (const wf::color_t& a, const wf::color_t& b)
+        {
+            return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+        };
+
+        return text == other.text && font == other.font && font_size == other.font_size &&
+               same_color(text_color, other.text_color) && same_color(bg_color, other.bg_color) &&
+               scale == other.scale && size == other.size && surface_size == other.surface_size &&
+               flags == other.flags;
+    }
+
+    struct hash
+    {
+        size_t operator ()(const text_texture_key_t& key) const
+        {
+            size_t h = std::hash<std::string>{}(key.text);
+            auto combine = [&h] (size_t v)
+            {
+                h ^= v + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+            };
+
+            combine(std::hash<std::string>{}(key.font));
+            combine(std::hash<double>{}(key.font_size));
+            for (const auto& color : {key.text_color, key.bg_color})
+            {
+                combine(std::hash<double>{}(color.r));
+                combine(std::hash<double>{}(color.g));
+                combine(std::hash<double>{}(color.b));
+                combine(std::hash<double>{}(color.a));
+            }
+
+            combine(std::hash<float>{}(key.scale));
+            combine(std::hash<int>{}(key.size.width));
+            combine(std::hash<int>{}(key.size.height));
+            combine(std::hash<int>{}(key.surface_size.width));
+            combine(std::hash<int>{}(key.surface_size.height));
+            combine(std::hash<uint32_t>{}(key.flags));
+            return h;
+        }
+    };
+};
+
+/**
+ * A cache of textures with rendered text, shared by all plugins via
+ * wf::shared_data::ref_ptr_t<text_texture_cache_t>.
+ *
+ * Rendering text with Pango is expensive, and the same strings (for example
+ * view titles) are often rendered over and over again by the decorations, by
+ * scale and by other overlays. With the cache, each distinct text is shaped
+ * and uploaded to the GPU once, and all users of the same text share the
+ * texture. The least recently used textures are dropped from the cache when
+ * it grows over its capacity. They stay alive as long as somebody uses them.
+ */
+class text_texture_cache_t
+{
+  public:
+    struct entry_t
+    {
+        std::shared_ptr<const owned_texture_t> texture;
+        /* renderer-specific size information, see cairo_text_t::render_text() */
+        wf::dimensions_t text_size = {0, 0};
+    };
+
+    /**
+     * Find the texture rendered with the given parameters, or render it with
+     * @render and add it to the cache.
+     */
+    entry_t get(const text_texture_key_t& key, const std::function<entry_t()>& render)
+    {
+        auto it = index.find(key);
+        if (it != index.end())
+        {
+            // Move to the front of the LRU list
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+
+        auto entry = render();
+        entries.emplace_front(key, entry);
+        index[key] = entries.begin();
+        used_bytes += get_bytes(entry);
+
+        while ((used_bytes > capacity_bytes) && (entries.size() > 1))
+        {
+            used_bytes -= get_bytes(entries.back().second);
+            index.erase(entries.back().first);
+            entries.pop_back();
+        }
+
+        return entry;
+    }
+
+    /**
+     * Set the maximal memory used by cached textures, in bytes.
+     */
+    void set_capacity(size_t bytes)
+    {
+        capacity_bytes = bytes;
+    }
+
+    size_t size() const
+    {
+        return entries.size();
+    }
+
+  private:
+    std::list<std::pair<text_texture_key_t, entry_t>> entries;
+    std::unordered_map<text_texture_key_t, decltype(entries)::iterator, text_texture_key_t::hash> index;
+    size_t used_bytes     = 0;
+    size_t capacity_bytes = 32 << 20;
+
+    static size_t get_bytes(const entry_t& entry)
+    {
+        auto size = entry.texture ? entry.texture->get_size() : wf::dimensions_t{0, 0};
+        return 4ul * size.width * size.height;
+    }
+};
+
 /**
  * Simple wrapper around rendering text with Cairo. This object can be
  * kept around to avoid reallocation of the cairo surface and OpenGL
@@ -159,6 +305,9 @@ struct cairo_text_t
     /**
      * Render the given text in the texture tex.
      *
+     * The result is looked up in the shared text_texture_cache_t first, so
+     * that the same text is not rendered twice.
+     *
      * @param text         text to render
      * @param par          parameters for rendering
      *
@@ -168,18 +317,144 @@ struct cairo_text_t
      *   that dimension.
      */
     wf::dimensions_t render_text(const std::string& text, const params& par)
+    {
+        if (!cache)
+        {
+            cache = std::make_unique<wf::shared_data::ref_ptr_t<text_texture_cache_t>>();
+        }
+
+        text_texture_key_t key;
+        key.text       = text;
+        key.font       = font;
+        key.font_size  = par.font_size;
+        key.text_color = par.text_color;
+        key.bg_color   = par.bg_rect ? par.bg_color : wf::color_t{0, 0, 0, 0};
+        key.scale = par.output_scale;
+        key.size  = par.max_size;
+        key.flags = text_cache_flags | (par.bg_rect << 0) | (par.rounded_rect << 1) | (par.exact_size << 2);
+        if (!par.exact_size)
+        {
+            /* the text is centered in the current surface if it is bigger */
+            key.surface_size = (cr || surface_size.width > 0) ? surface_size : default_surface_size;
+        }
+
+        bool rendered = false;
+        auto entry    = (*cache)->get(key, [&] ()
+        {
+            rendered = true;
+            return rasterize(text, par);
+        });
+
+        if (!rendered)
+        {
+            /* The surface is out of date now, but we need to remember its
+             * size for the next texts to come out the same as without the cache. */
+            cairo_free();
+            surface_size = entry.texture->get_size();
+        }
+
+        this->tex = entry.texture;
+        return entry.text_size;
+    }
+
+    cairo_text_t() = default;
+    ~cairo_text_t()
+    {
+        cairo_free();
+    }
+
+    cairo_text_t(const cairo_text_t &) = delete;
+    cairo_text_t& operator =(const cairo_text_t&) = delete;
+
+    cairo_text_t(cairo_text_t && o) noexcept : cr(o.cr), surface(o.surface),
+        surface_size(o.surface_size), tex(std::move(o.tex)), cache(std::move(o.cache))
+    {
+        o.cr = nullptr;
+        o.surface = nullptr;
+    }
+
+    cairo_text_t& operator =(cairo_text_t&& o) noexcept
+    {
+        if (&o == this)
+        {
+            return *this;
+        }
+
+        cairo_free();
+
+        tex   = std::move(o.tex);
+        cache = std::move(o.cache);
+        cr    = o.cr;
+        surface = o.surface;
+        surface_size = o.surface_size;
+
+        o.cr = nullptr;
+        o.surface = nullptr;
+        return *this;
+    }
+
+    /**
+     * Calculate the height of text rendered with a given font size.
+     *
+     * @param font_size  Desired font size.
+     * @param bg_rect    Whether a background rectangle should be taken into account.
+     *
+     * @returns Required height of the surface.
+     */
+    static unsigned int measure_height(int font_size, bool bg_rect = true)
+    {
+        cairo_text_t dummy;
+        dummy.cairo_create_surface({1, 1});
+
+        cairo_font_extents_t font_extents;
+        /* TODO: font properties could be made parameters! */
+        cairo_select_font_face(dummy.cr, "sans-serif", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+        cairo_set_font_size(dummy.cr, font_size);
+        cairo_font_extents(dummy.cr, &font_extents);
+
+        double ypad    = bg_rect ? 0.2 * (font_extents.ascent + font_extents.descent) : 0.0;
+        unsigned int h = (unsigned int)std::ceil(font_extents.ascent + font_extents.descent + 2 * ypad);
+        return h;
+    }
+
+    wf::dimensions_t get_size() const
+    {
+        return surface_size;
+    }
+
+    wf::texture_t get_texture() const
+    {
+        return tex ? tex->get_texture() : wf::texture_t{};
+    }
+
+  protected:
+    /* TODO: font properties could be made parameters! */
+    static constexpr const char *font = "sans-serif bold";
+    static constexpr wf::dimensions_t default_surface_size = {400, 100};
+    /* identifies the textures of cairo_text_t in the text_texture_cache_t */
+    static constexpr uint32_t text_cache_flags = 1 << 8;
+
+    /* cairo context and surface for the text */
+    cairo_t *cr = nullptr;
+    cairo_surface_t *surface = nullptr;
+    /* current width and height of the above surface */
+    wf::dimensions_t surface_size = {0, 0};
+
+    std::shared_ptr<const owned_texture_t> tex;
+    std::unique_ptr<wf::shared_data::ref_ptr_t<text_texture_cache_t>> cache;
+
+    /* Render the text with Pango, without looking at the cache */
+    text_texture_cache_t::entry_t rasterize(const std::string& text, const params& par)
     {
         if (!cr)
         {
-            /* create with default size */
-            cairo_create_surface();
+            cairo_create_surface(surface_size.width > 0 ? surface_size : default_surface_size);
         }
 
         PangoFontDescription *font_desc;
         PangoLayout *layout;
         PangoRectangle extents;
-        /* TODO: font properties could be made parameters! */
-        font_desc = pango_font_description_from_string("sans-serif bold");
+        font_desc = pango_font_description_from_string(font);
         pango_font_description_set_absolute_size(font_desc,
             par.font_size * par.output_scale * PANGO_SCALE);
         layout = pango_cairo_create_layout(cr);
@@ -266,87 +541,9 @@ struct cairo_text_t
         g_object_unref(layout);
 
         cairo_surface_flush(surface);
-        this->tex = owned_texture_t{surface};
-        return ret;
+        return {std::make_shared<owned_texture_t>(surface), ret};
     }
 
-    cairo_text_t() = default;
-    ~cairo_text_t()
-    {
-        cairo_free();
-    }
-
-    cairo_text_t(const cairo_text_t &) = delete;
-    cairo_text_t& operator =(const cairo_text_t&) = delete;
-
-    cairo_text_t(cairo_text_t && o) noexcept : cr(o.cr), surface(o.surface),
-        surface_size(o.surface_size), tex(std::move(o.tex))
-    {
-        o.cr = nullptr;
-        o.surface = nullptr;
-    }
-
-    cairo_text_t& operator =(cairo_text_t&& o) noexcept
-    {
-        if (&o == this)
-        {
-            return *this;
-        }
-
-        cairo_free();
-
-        tex = std::move(o.tex);
-        cr  = o.cr;
-        surface = o.surface;
-        surface_size = o.surface_size;
-
-        o.cr = nullptr;
-        o.surface = nullptr;
-        return *this;
-    }
-
-    /**
-     * Calculate the height of text rendered with a given font size.
-     *
-     * @param font_size  Desired font size.
-     * @param bg_rect    Whether a background rectangle should be taken into account.
-     *
-     * @returns Required height of the surface.
-     */
-    static unsigned int measure_height(int font_size, bool bg_rect = true)
-    {
-        cairo_text_t dummy;
-        dummy.cairo_create_surface({1, 1});
-
-        cairo_font_extents_t font_extents;
-        /* TODO: font properties could be made parameters! */
-        cairo_select_font_face(dummy.cr, "sans-serif", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size(dummy.cr, font_size);
-        cairo_font_extents(dummy.cr, &font_extents);
-
-        double ypad    = bg_rect ? 0.2 * (font_extents.ascent + font_extents.descent) : 0.0;
-        unsigned int h = (unsigned int)std::ceil(font_extents.ascent + font_extents.descent + 2 * ypad);
-        return h;
-    }
-
-    wf::dimensions_t get_size() const
-    {
-        return surface_size;
-    }
-
-    wf::texture_t get_texture() const
-    {
-        return this->tex.get_texture();
-    }
-
-  protected:
-    /* cairo context and surface for the text */
-    cairo_t *cr = nullptr;
-    cairo_surface_t *surface = nullptr;
-    /* current width and height of the above surface */
-    wf::dimensions_t surface_size = {0, 0};
-
-
     void cairo_free()
     {
         if (cr)
@@ -363,14 +560,12 @@ struct cairo_text_t
         surface = nullptr;
     }
 
-    void cairo_create_surface(wf::dimensions_t size = {400, 100})
+    void cairo_create_surface(wf::dimensions_t size = default_surface_size)
     {
         cairo_free();
         this->surface_size = size;
         surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, surface_size.width, surface_size.height);
         cr = cairo_create(surface);
     }
-
-    owned_texture_t tex;
 };
 }
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include "wayfire/geometry.hpp"
+#include "wayfire/output.hpp"
+#include "wayfire/region.hpp"
+#include "wayfire/render.hpp"
+
+namespace wf
+{
+/**
+ * A cache of low-resolution copies of the workspaces of an output.
+ *
+ * The cache keeps a thumbnail of each workspace, scaled down so that the
+ * whole workspace grid fits on the output. Damage on the workspaces is
+ * accumulated in the background, and the damaged thumbnails are repainted
+ * one at a time, at most once per update interval. This way, a workspace wall
+ * can show all workspaces as soon as it is started, instead of rendering
+ * each of them from scratch.
+ *
+ * There is at most one cache per output, which is shared by all its users and
+ * destroyed together with the last of them.
+ */
+class workspace_thumbnail_cache_t
+{
+  public:
+    /**
+     * Get the thumbnail cache of the given output, creating it if necessary.
+     */
+    static std::shared_ptr<workspace_thumbnail_cache_t> get(wf::output_t *output);
+
+    workspace_thumbnail_cache_t(wf::output_t *output);
+    ~workspace_thumbnail_cache_t();
+
+    /**
+     * Set the interval in milliseconds at which damaged thumbnails are
+     * repainted. Only one thumbnail is repainted per interval.
+     */
+    void set_update_interval(int interval_ms);
+
+    /**
+     * Get the scale of the thumbnails relative to the workspaces.
+     */
+    float get_scale() const;
+
+    /**
+     * Copy the thumbnail of a workspace to the top-left corner of the given
+     * buffer, which has the size of the full workspace.
+     *
+     * @param ws The workspace whose thumbnail should be copied.
+     * @param buffer The buffer to copy the thumbnail to.
+     * @param damage Set to the parts of the workspace which are outdated in
+     *   the thumbnail, in workspace-local coordinates.
+     *
+     * @return The part of the buffer which contains the thumbnail, or
+     *   std::nullopt if there is no up-to-date thumbnail of the workspace.
+     */
+    std::optional<wf::geometry_t> restore(wf::point_t ws,
+        wf::auxilliary_buffer_t& buffer, wf::region_t& damage);
+
+    /**
+     * Update the thumbnail of a workspace from a buffer containing the workspace.
+     *
+     * @param ws The workspace shown in the buffer.
+     * @param buffer The buffer to copy the workspace from.
+     * @param subbox The part of the buffer which contains the workspace, or
+     *   std::nullopt if the workspace covers the whole buffer.
+     * @param damage The parts of the workspace which are outdated in the
+     *   buffer, in workspace-local coordinates.
+     */
+    void store(wf::point_t ws, wf::auxilliary_buffer_t& buffer,
+        std::optional<wf::geometry_t> subbox, const wf::region_t& damage);
+
+    /**
+     * Notify the cache that a workspace wall started or stopped rendering the
+     * workspaces. While a wall is active, the thumbnails are not repainted.
+     */
+    void set_wall_active(bool active);
+
+  private:
+    class impl;
+    std::unique_ptr<impl> priv;
+};
+}
@@ -14,6 +14,8 @@
 
 namespace wf
 {
+class workspace_thumbnail_cache_t;
+
 /**
  * When the workspace wall is rendered via a render hook, the frame event
  * is emitted on each frame.
@@ -111,6 +113,22 @@ class workspace_wall_t : public wf::signal::provider_t
      */
     void set_ws_dim(const wf::point_t& ws, float value);
 
+    /**
+     * Keep low-resolution thumbnails of the workspaces while the wall is not
+     * rendered, see workspace_thumbnail_cache_t.
+     *
+     * When the output renderer is started, workspaces which are not visible in
+     * the viewport at that time are initialized from the thumbnails instead of
+     * being rendered from scratch. They are shown at the thumbnail resolution
+     * until they are damaged, so this is useful for walls which zoom out to
+     * show the whole workspace grid.
+     *
+     * @param enabled Whether to use the thumbnail cache of the output.
+     * @param update_interval The interval in milliseconds at which outdated
+     *   thumbnails are repainted, one at a time.
+     */
+    void set_thumbnail_cache(bool enabled, int update_interval = 500);
+
   protected:
     wf::output_t *output;
 
@@ -125,6 +143,8 @@ class workspace_wall_t : public wf::signal::provider_t
      */
     std::vector<wf::point_t> get_visible_workspaces(wf::geometry_t viewport) const;
 
+    std::shared_ptr<workspace_thumbnail_cache_t> thumbnails;
+
   protected:
     class workspace_wall_node_t;
     std::shared_ptr<workspace_wall_node_t> render_node;
@@ -0,0 +1,352 @@
+#include "wayfire/plugins/common/workspace-thumbnail-cache.hpp"
+#include "workspace-thumbnail-tracker.hpp"
+#include "wayfire/scene-operations.hpp"
+#include "wayfire/workspace-stream.hpp"
+#include "wayfire/workspace-set.hpp"
+#include "wayfire/signal-definitions.hpp"
+#include "wayfire/scene-render.hpp"
+#include "wayfire/scene.hpp"
+#include "wayfire/object.hpp"
+#include "wayfire/core.hpp"
+#include "wayfire/util.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+
+namespace wf
+{
+namespace
+{
+/* Stored on the output, so that all users of the output share the cache. */
+struct thumbnail_cache_ref_t : public wf::custom_data_t
+{
+    std::weak_ptr<workspace_thumbnail_cache_t> cache;
+};
+}
+
+using ws_key_t = std::pair<int, int>;
+
+class workspace_thumbnail_cache_t::impl
+{
+    /*
+     * An invisible node which contains the workspace streams of the output.
+     *
+     * Its render instances are regenerated together with the rest of the
+     * scenegraph, so the cache always has up-to-date render instances for each
+     * workspace, and receives the damage on the workspaces without damaging
+     * the output.
+     */
+    class thumbnail_node_t : public scene::node_t
+    {
+      public:
+        class thumbnail_render_instance_t : public scene::render_instance_t
+        {
+            std::shared_ptr<thumbnail_node_t> self;
+            // Keep the streams alive, the instances generated from them refer to them
+            std::map<ws_key_t, std::shared_ptr<workspace_stream_node_t>> streams;
+
+          public:
+            std::map<ws_key_t, std::vector<scene::render_instance_uptr>> instances;
+
+            thumbnail_render_instance_t(thumbnail_node_t *self)
+            {
+                this->self    = std::dynamic_pointer_cast<thumbnail_node_t>(self->shared_from_this());
+                this->streams = self->cache->streams;
+                for (auto& [ws, stream] : streams)
+                {
+                    auto push_damage = [self = this->self, ws = ws] (const wf::region_t& damage)
+                    {
+                        if (self->cache)
+                        {
+                            self->cache->tracker.add_damage({ws.first, ws.second}, damage);
+                        }
+                    };
+
+                    stream->gen_render_instances(instances[ws], push_damage, self->cache->output);
+                }
+
+                self->cache->live_instances.push_back(this);
+            }
+
+            ~thumbnail_render_instance_t()
+            {
+                if (self->cache)
+                {
+                    auto& live = self->cache->live_instances;
+                    live.erase(std::remove(live.begin(), live.end(), this), live.end());
+                }
+            }
+
+            void schedule_instructions(std::vector<scene::render_instruction_t>&,
+                const wf::render_target_t&, wf::region_t&) override
+            {
+                // Nothing to render, the thumbnails are painted by the cache.
+            }
+
+            void render(const wf::scene::render_instruction_t&) override
+            {}
+        };
+
+        // Reset when the cache is destroyed, render instances may outlive it.
+        impl *cache;
+
+        thumbnail_node_t(impl *cache) : node_t(false), cache(cache)
+        {}
+
+        void gen_render_instances(std::vector<scene::render_instance_uptr>& instances,
+            scene::damage_callback, wf::output_t *shown_on) override
+        {
+            if (!cache || (shown_on != cache->output))
+            {
+                return;
+            }
+
+            cache->update_streams();
+            instances.push_back(std::make_unique<thumbnail_render_instance_t>(this));
+        }
+
+        std::string stringify() const override
+        {
+            return "workspace-thumbnail-cache " + stringify_flags();
+        }
+
+        wf::geometry_t get_bounding_box() override
+        {
+            return {0, 0, 0, 0};
+        }
+    };
+
+  public:
+    wf::output_t *output;
+    std::map<ws_key_t, wf::auxilliary_buffer_t> buffers;
+    workspace_thumbnail_tracker_t tracker;
+    std::map<ws_key_t, std::shared_ptr<workspace_stream_node_t>> streams;
+    std::vector<thumbnail_node_t::thumbnail_render_instance_t*> live_instances;
+    std::shared_ptr<thumbnail_node_t> node;
+
+    int active_walls = 0;
+    wf::wl_timer<true> update_timer;
+
+    wf::signal::connection_t<workspace_grid_changed_signal> on_grid_changed = [=] (auto)
+    {
+        invalidate();
+    };
+
+    wf::signal::connection_t<workspace_set_changed_signal> on_wset_changed =
+        [=] (workspace_set_changed_signal *ev)
+    {
+        on_grid_changed.disconnect();
+        ev->new_wset->connect(&on_grid_changed);
+        invalidate();
+    };
+
+    impl(wf::output_t *output) : output(output)
+    {
+        output->connect(&on_wset_changed);
+        output->wset()->connect(&on_grid_changed);
+
+        node = std::make_shared<thumbnail_node_t>(this);
+        scene::add_back(wf::get_core().scene(), node);
+    }
+
+    ~impl()
+    {
+        update_timer.disconnect();
+        node->cache = nullptr;
+        scene::remove_child(node);
+    }
+
+    float get_scale() const
+    {
+        auto grid = output->wset()->get_workspace_grid_size();
+        return 1.0 / std::max({grid.width, grid.height, 1});
+    }
+
+    wf::geometry_t get_workspace_box() const
+    {
+        return output->get_relative_geometry();
+    }
+
+    wf::dimensions_t get_thumbnail_size() const
+    {
+        auto box = get_workspace_box();
+        const float scale = output->handle->scale * get_scale();
+        return {
+            (int)std::ceil(box.width * scale),
+            (int)std::ceil(box.height * scale),
+        };
+    }
+
+    wf::buffer_reallocation_result_t allocate(wf::auxilliary_buffer_t& buffer)
+    {
+        return buffer.allocate(wf::dimensions(get_workspace_box()),
+            output->handle->scale * get_scale(), wf::buffer_allocation_hints_t{
+                .needs_alpha = false,
+            });
+    }
+
+    /* Create a workspace stream for each workspace of the current grid. */
+    void update_streams()
+    {
+        auto grid = output->wset()->get_workspace_grid_size();
+        if (streams.size() == (size_t)(grid.width * grid.height))
+        {
+            return;
+        }
+
+        streams.clear();
+        for (int i = 0; i < grid.width; i++)
+        {
+            for (int j = 0; j < grid.height; j++)
+            {
+                streams[{i, j}] = std::make_shared<workspace_stream_node_t>(output, wf::point_t{i, j});
+            }
+        }
+    }
+
+    /* Drop all thumbnails, for example because the workspace grid changed. */
+    void invalidate()
+    {
+        buffers.clear();
+        tracker.reset();
+        streams.clear();
+        scene::update(node, scene::update_flag::CHILDREN_LIST);
+    }
+
+    void repaint(wf::point_t ws)
+    {
+        auto& instances = live_instances.back()->instances;
+        auto it = instances.find({ws.x, ws.y});
+        if (it == instances.end())
+        {
+            return;
+        }
+
+        auto& buffer = buffers[{ws.x, ws.y}];
+        auto result  = allocate(buffer);
+        if (result == wf::buffer_reallocation_result_t::FAILED)
+        {
+            return;
+        }
+
+        const auto box  = get_workspace_box();
+        const auto size = get_thumbnail_size();
+        const bool reuse = (result == wf::buffer_reallocation_result_t::SAME) && tracker.is_valid(ws, size);
+
+        wf::render_target_t target{buffer};
+        target.geometry = box;
+        target.scale    = output->handle->scale * get_scale();
+
+        render_pass_params_t params;
+        params.instances = &it->second;
+        params.damage    = reuse ? (tracker.get_damage(ws) & box) : wf::region_t{box};
+        params.target    = target;
+        params.reference_output = output;
+        params.flags = RPASS_EMIT_SIGNALS;
+        wf::render_pass_t::run(params);
+
+        tracker.set_painted(ws, size);
+    }
+
+    /* Repaint the next thumbnail which is outdated. */
+    void update_next_thumbnail()
+    {
+        if ((active_walls > 0) || live_instances.empty())
+        {
+            return;
+        }
+
+        auto grid = output->wset()->get_workspace_grid_size();
+        if (auto ws = tracker.next_outdated(grid, get_thumbnail_size()))
+        {
+            repaint(*ws);
+        }
+    }
+};
+
+std::shared_ptr<workspace_thumbnail_cache_t> workspace_thumbnail_cache_t::get(wf::output_t *output)
+{
+    auto ref = output->get_data_safe<thumbnail_cache_ref_t>();
+    if (auto cache = ref->cache.lock())
+    {
+        return cache;
+    }
+
+    auto cache = std::make_shared<workspace_thumbnail_cache_t>(output);
+    ref->cache = cache;
+    return cache;
+}
+
+workspace_thumbnail_cache_t::workspace_thumbnail_cache_t(wf::output_t *output)
+{
+    this->priv = std::make_unique<impl>(output);
+}
+
+workspace_thumbnail_cache_t::~workspace_thumbnail_cache_t() = default;
+
+void workspace_thumbnail_cache_t::set_update_interval(int interval_ms)
+{
+    priv->update_timer.set_timeout(std::max(interval_ms, 1), [=] ()
+    {
+        priv->update_next_thumbnail();
+        return true;
+    });
+}
+
+float workspace_thumbnail_cache_t::get_scale() const
+{
+    return priv->get_scale();
+}
+
+std::optional<wf::geometry_t> workspace_thumbnail_cache_t::restore(wf::point_t ws,
+    wf::auxilliary_buffer_t& buffer, wf::region_t& damage)
+{
+    // If the output has changed since the thumbnail was painted, it has a different size
+    const auto size = priv->get_thumbnail_size();
+    auto it = priv->buffers.find({ws.x, ws.y});
+    if ((it == priv->buffers.end()) || !priv->tracker.is_valid(ws, size) || (it->second.get_size() != size))
+    {
+        return {};
+    }
+
+    const auto full_size = buffer.get_size();
+    wf::geometry_t subbox{0, 0,
+        std::min(size.width, full_size.width), std::min(size.height, full_size.height)};
+    buffer.get_renderbuffer().blit(it->second,
+        wlr_fbox{0, 0, 1.0 * size.width, 1.0 * size.height}, subbox);
+
+    damage = priv->tracker.get_damage(ws);
+    return subbox;
+}
+
+void workspace_thumbnail_cache_t::store(wf::point_t ws, wf::auxilliary_buffer_t& buffer,
+    std::optional<wf::geometry_t> subbox, const wf::region_t& damage)
+{
+    if ((wf::region_t{priv->get_workspace_box()} ^ damage).empty())
+    {
+        // Nothing of the workspace was painted in the buffer
+        priv->tracker.add_damage(ws, damage);
+        return;
+    }
+
+    auto& thumbnail = priv->buffers[{ws.x, ws.y}];
+    if (priv->allocate(thumbnail) == wf::buffer_reallocation_result_t::FAILED)
+    {
+        return;
+    }
+
+    const auto source = subbox.value_or(wf::geometry_t{0, 0, buffer.get_size().width,
+        buffer.get_size().height});
+    const auto size = thumbnail.get_size();
+    thumbnail.get_renderbuffer().blit(buffer, wf::geometry_to_fbox(source),
+        wf::geometry_t{0, 0, size.width, size.height});
+
+    priv->tracker.set_painted(ws, priv->get_thumbnail_size(), damage);
+}
+
+void workspace_thumbnail_cache_t::set_wall_active(bool active)
+{
+    priv->active_walls += active ? 1 : -1;
+}
+} // namespace wf
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <utility>
+#include "wayfire/geometry.hpp"
+#include "wayfire/region.hpp"
+
+namespace wf
+{
+/**
+ * Keeps track of which workspace thumbnails of a workspace_thumbnail_cache_t are
+ * up to date, and which parts of them are outdated.
+ *
+ * The buffers themselves are managed by the cache, so that the bookkeeping can
+ * be used (and tested) without a renderer.
+ */
+class workspace_thumbnail_tracker_t
+{
+  public:
+    /**
+     * Forget all thumbnails, for example because the workspace grid changed.
+     */
+    void reset()
+    {
+        thumbnails.clear();
+        next_workspace = 0;
+    }
+
+    /**
+     * Mark a part of a workspace as outdated, in workspace-local coordinates.
+     */
+    void add_damage(wf::point_t ws, const wf::region_t& damage)
+    {
+        thumbnails[key(ws)].damage |= damage;
+    }
+
+    /**
+     * Record that the thumbnail of a workspace was painted with the given size.
+     *
+     * @param damage The parts of the workspace which are still outdated.
+     */
+    void set_painted(wf::point_t ws, wf::dimensions_t size, const wf::region_t& damage = {})
+    {
+        auto& thumbnail = thumbnails[key(ws)];
+        thumbnail.size   = size;
+        thumbnail.damage = damage;
+    }
+
+    /**
+     * @return Whether the thumbnail of the workspace was painted with the given
+     *   size, i.e. whether its contents can be reused.
+     */
+    bool is_valid(wf::point_t ws, wf::dimensions_t size) const
+    {
+        auto it = thumbnails.find(key(ws));
+        return (it != thumbnails.end()) && it->second.size.has_value() && (*it->second.size == size);
+    }
+
+    /**
+     * @return The parts of the workspace which are outdated in its thumbnail.
+     */
+    wf::region_t get_damage(wf::point_t ws) const
+    {
+        auto it = thumbnails.find(key(ws));
+        return (it == thumbnails.end()) ? wf::region_t{} : it->second.damage;
+    }
+
+    /**
+     * Find the next workspace whose thumbnail has to be repainted, going over
+     * the workspaces in a round-robin fashion so that no workspace is starved.
+     *
+     * @param grid The size of the workspace grid.
+     * @param size The size the thumbnails should have.
+     */
+    std::optional<wf::point_t> next_outdated(wf::dimensions_t grid, wf::dimensions_t size)
+    {
+        const int count = grid.width * grid.height;
+        for (int k = 0; k < count; k++)
+        {
+            const int idx = (next_workspace + k) % count;
+            const wf::point_t ws = {idx % grid.width, idx / grid.width};
+            if (!is_valid(ws, size) || !get_damage(ws).empty())
+            {
+                next_workspace = idx + 1;
+                return ws;
+            }
+        }
+
+        return {};
+    }
+
+  private:
+    struct thumbnail_state_t
+    {
+        // The size the thumbnail was last painted with, if it was painted at all
+        std::optional<wf::dimensions_t> size;
+        // Damage accumulated since the thumbnail was last painted
+        wf::region_t damage;
+    };
+
+    static std::pair<int, int> key(wf::point_t ws)
+    {
+        return {ws.x, ws.y};
+    }
+
+    std::map<std::pair<int, int>, thumbnail_state_t> thumbnails;
+    int next_workspace = 0;
+};
+}
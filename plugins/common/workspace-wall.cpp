@@ -1,4 +1,5 @@
 #include "wayfire/plugins/common/workspace-wall.hpp"
+#include "wayfire/plugins/common/workspace-thumbnail-cache.hpp"
 #include "wayfire/scene-input.hpp"
 #include "wayfire/scene-operations.hpp"
 #include "wayfire/workspace-stream.hpp"
@@ -109,9 +110,17 @@ class workspace_wall_t::workspace_wall_node_t : public scene::node_t
             // Avoid keeping a low resolution if we are going up in the scale (for example, expo exit
             // animation) and we're close to the 1.0 scale. Otherwise, we risk popping artifacts as we
             // suddenly switch from low to high resolution.
-            const bool rescale_magnification = (render_scale > 0.5) &&
+            bool rescale_magnification = (render_scale > 0.5) &&
                 (render_scale > current_scale * 1.1);
 
+            // Buffers restored from the thumbnail cache have a low resolution from the start. Keep them
+            // while the wall zooms out to them, instead of rendering them from scratch on the first frame.
+            if (self->aux_buffer_from_cache[i][j])
+            {
+                rescale_magnification = false;
+                self->aux_buffer_from_cache[i][j] = (render_scale > current_scale * 1.1);
+            }
+
             // In general, it is worth changing the buffer scale if we have a lot of damage to the old
             // buffer, so that for ex. a full re-scale is actually cheaper than repaiting the old buffer.
             // This could easily happen for example if we have a video player during Expo start animation.
@@ -263,6 +272,41 @@ class workspace_wall_t::workspace_wall_node_t : public scene::node_t
                 aux_buffer_damage[i][j] |= bbox;
                 aux_buffer_current_scale[i][j]  = 1.0;
                 aux_buffer_current_subbox[i][j] = std::nullopt;
+                aux_buffer_from_cache[i][j]     = false;
+
+                // Workspaces which are visible right away are rendered in full resolution
+                if (wall->thumbnails && !(wall->viewport & wall->get_workspace_rectangle({i, j})))
+                {
+                    restore_from_cache(i, j);
+                }
+            }
+        }
+    }
+
+    void restore_from_cache(int i, int j)
+    {
+        wf::region_t damage;
+        auto subbox = wall->thumbnails->restore({i, j}, aux_buffers[i][j], damage);
+        if (subbox)
+        {
+            aux_buffer_damage[i][j] = damage;
+            aux_buffer_current_scale[i][j]  = wall->thumbnails->get_scale();
+            aux_buffer_current_subbox[i][j] = subbox;
+            aux_buffer_from_cache[i][j]     = true;
+        }
+    }
+
+    /**
+     * Update the thumbnail cache with the contents of the workspace buffers.
+     */
+    void store_to_cache()
+    {
+        for (int i = 0; i < (int)workspaces.size(); i++)
+        {
+            for (int j = 0; j < (int)workspaces[i].size(); j++)
+            {
+                wall->thumbnails->store({i, j}, aux_buffers[i][j],
+                    aux_buffer_current_subbox[i][j], aux_buffer_damage[i][j]);
             }
         }
     }
@@ -302,6 +346,8 @@ class workspace_wall_t::workspace_wall_node_t : public scene::node_t
     per_workspace_map_t<float> aux_buffer_current_scale;
     // Current subbox for the workspace
     per_workspace_map_t<std::optional<wf::geometry_t>> aux_buffer_current_subbox;
+    // Whether the buffer was restored from the thumbnail cache and was not rescaled since then
+    per_workspace_map_t<bool> aux_buffer_from_cache;
 };
 
 workspace_wall_t::workspace_wall_t(wf::output_t *_output) : output(_output)
@@ -351,6 +397,10 @@ void workspace_wall_t::start_output_renderer()
     wf::dassert(render_node == nullptr, "Starting workspace-wall twice?");
     render_node = std::make_shared<workspace_wall_node_t>(this);
     scene::add_front(wf::get_core().scene(), render_node);
+    if (thumbnails)
+    {
+        thumbnails->set_wall_active(true);
+    }
 }
 
 void workspace_wall_t::stop_output_renderer(bool reset_viewport)
@@ -360,6 +410,12 @@ void workspace_wall_t::stop_output_renderer(bool reset_viewport)
         return;
     }
 
+    if (thumbnails)
+    {
+        render_node->store_to_cache();
+        thumbnails->set_wall_active(false);
+    }
+
     scene::remove_child(render_node);
     render_node = nullptr;
 
@@ -397,6 +453,24 @@ void workspace_wall_t::set_ws_dim(const wf::point_t& ws, float value)
     }
 }
 
+void workspace_wall_t::set_thumbnail_cache(bool enabled, int update_interval)
+{
+    if (render_node && thumbnails)
+    {
+        thumbnails->set_wall_active(false);
+    }
+
+    thumbnails = enabled ? workspace_thumbnail_cache_t::get(output) : nullptr;
+    if (thumbnails)
+    {
+        thumbnails->set_update_interval(update_interval);
+        if (render_node)
+        {
+            thumbnails->set_wall_active(true);
+        }
+    }
+}
+
 float workspace_wall_t::get_color_for_workspace(wf::point_t ws)
 {
     auto it = render_colors.find({ws.x, ws.y});
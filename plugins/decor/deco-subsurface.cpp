@@ -49,12 +49,12 @@ class simple_decoration_node_t : public wf::scene::node_t, public wf::pointer_in
                 static_cast<int32_t>(height * scale)
             };
 
-            if ((title_texture.tex.get_size() != target_size) ||
+            if ((title_texture.size != target_size) ||
                 (title_texture.current_text != view->get_title()))
             {
-                auto surface = theme.render_text(view->get_title(), target_size.width, target_size.height);
-                title_texture.tex = wf::owned_texture_t{surface};
-                cairo_surface_destroy(surface);
+                title_texture.tex = theme.get_text_texture(view->get_title(),
+                    target_size.width, target_size.height);
+                title_texture.size = target_size;
                 title_texture.current_text = view->get_title();
             }
         }
@@ -62,7 +62,8 @@ class simple_decoration_node_t : public wf::scene::node_t, public wf::pointer_in
 
     struct
     {
-        wf::owned_texture_t tex;
+        std::shared_ptr<const wf::owned_texture_t> tex;
+        wf::dimensions_t size = {0, 0};
         std::string current_text = "";
     } title_texture;
 
@@ -124,9 +125,9 @@ class simple_decoration_node_t : public wf::scene::node_t, public wf::pointer_in
             {
                 wf::geometry_t title_geometry = item->get_geometry() + origin;
                 update_title(title_geometry.width, title_geometry.height, data.target.scale);
-                if (title_texture.tex.get_texture().texture != NULL)
+                if (title_texture.tex && (title_texture.tex->get_texture().texture != NULL))
                 {
-                    data.pass->add_texture(title_texture.tex.get_texture(), data.target,
+                    data.pass->add_texture(title_texture.tex->get_texture(), data.target,
                         title_geometry, data.damage);
                 }
             } else // button
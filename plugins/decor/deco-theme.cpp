@@ -84,6 +84,30 @@ cairo_surface_t*decoration_theme_t::render_text(std::string text,
     return surface;
 }
 
+std::shared_ptr<const wf::owned_texture_t> decoration_theme_t::get_text_texture(
+    const std::string& text, int width, int height) const
+{
+    /* identifies the textures of the decoration in the text texture cache */
+    constexpr uint32_t text_cache_flags = 1 << 9;
+
+    wf::text_texture_key_t key;
+    key.text       = text;
+    key.font       = font;
+    key.text_color = font_color;
+    key.size  = {width, height};
+    key.flags = text_cache_flags;
+
+    auto entry = text_cache->get(key, [&] () -> wf::text_texture_cache_t::entry_t
+    {
+        auto surface = render_text(text, width, height);
+        auto texture = std::make_shared<wf::owned_texture_t>(surface);
+        cairo_surface_destroy(surface);
+        return {texture, {width, height}};
+    });
+
+    return entry.texture;
+}
+
 cairo_surface_t*decoration_theme_t::get_button_surface(button_type_t button,
     const button_state_t& state) const
 {
@@ -2,6 +2,7 @@
 #include <wayfire/render-manager.hpp>
 #include <wayfire/scene-render.hpp>
 #include "deco-button.hpp"
+#include <wayfire/plugins/common/cairo-util.hpp>
 
 namespace wf
 {
@@ -41,6 +42,14 @@ class decoration_theme_t
      */
     cairo_surface_t *render_text(std::string text, int width, int height) const;
 
+    /**
+     * Get a texture with the given text rendered with the given size, like
+     * render_text(). The texture is shared with other users of the same text
+     * via the text texture cache.
+     */
+    std::shared_ptr<const wf::owned_texture_t> get_text_texture(const std::string& text,
+        int width, int height) const;
+
     struct button_state_t
     {
         /** Button width */
@@ -71,6 +80,8 @@ class decoration_theme_t
     wf::option_wrapper_t<int> border_size{"decoration/border_size"};
     wf::option_wrapper_t<wf::color_t> active_color{"decoration/active_color"};
     wf::option_wrapper_t<wf::color_t> inactive_color{"decoration/inactive_color"};
+
+    mutable wf::shared_data::ref_ptr_t<wf::text_texture_cache_t> text_cache;
 };
 }
 }
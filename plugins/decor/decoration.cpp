@@ -73,7 +73,7 @@ class wayfire_decoration : public wf::plugin_interface_t
         wf::get_core().tx_manager->connect(&on_new_tx);
         wf::get_core().connect(&on_view_tiled);
 
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             update_view_decoration(view);
         }
@@ -81,7 +81,7 @@ class wayfire_decoration : public wf::plugin_interface_t
 
     void fini() override
     {
-        for (auto view : wf::get_core().get_all_views())
+        for (auto view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             if (auto toplevel = wf::toplevel_cast(view))
             {
@@ -7,6 +7,8 @@
 #include "wayfire/seat.hpp"
 #include <wayfire/per-output-plugin.hpp>
 #include <wayfire/signal-definitions.hpp>
+#include <wayfire/render-manager.hpp>
+#include <wayfire/util.hpp>
 #include "plugins/wm-actions/wm-actions-signals.hpp"
 
 // private API, used to make it easier to serialize output state
@@ -52,6 +54,8 @@ class ipc_rules_events_methods_t : public wf::per_output_tracker_mixin_t<>
                 event.register_output(output);
             }
         }
+
+        output->connect(&on_frame_done);
     }
 
     void handle_output_removed(wf::output_t *output) override
@@ -161,6 +165,43 @@ class ipc_rules_events_methods_t : public wf::per_output_tracker_mixin_t<>
     {
         std::set<std::string> connected_events;
         bool connected_all = false;
+
+        bool is_subscribed(const std::string& event_name, bool custom_event) const
+        {
+            return connected_events.empty() || connected_events.count(event_name) ||
+                   (custom_event && connected_all);
+        }
+
+        // Minimum time between geometry updates sent for a view, in milliseconds (0 means no limit).
+        int64_t min_geometry_interval = 0;
+        // View id -> time of the last geometry event sent for the view, for views still rate-limited.
+        std::map<uint32_t, int64_t> last_geometry_event;
+        // Geometry changes which were not sent yet because of the rate limit, view id -> old geometry,
+        // in the order they happened.
+        std::vector<std::pair<uint32_t, wf::geometry_t>> postponed_geometry;
+        std::unique_ptr<wf::wl_timer<false>> rate_limit_timer = std::make_unique<wf::wl_timer<false>>();
+        std::unique_ptr<wf::wl_idle_call> rate_limit_idle     = std::make_unique<wf::wl_idle_call>();
+
+        int64_t next_geometry_event_allowed(uint32_t id) const
+        {
+            auto it = last_geometry_event.find(id);
+            return (it == last_geometry_event.end()) ? 0 : it->second + min_geometry_interval;
+        }
+
+        // Forget the views whose interval has passed, they are no longer rate-limited.
+        void expire_geometry_rate_limits(int64_t now)
+        {
+            for (auto it = last_geometry_event.begin(); it != last_geometry_event.end();)
+            {
+                if (it->second + min_geometry_interval <= now)
+                {
+                    it = last_geometry_event.erase(it);
+                } else
+                {
+                    ++it;
+                }
+            }
+        }
     };
 
     // Track a list of clients which have requested watch
@@ -175,12 +216,24 @@ class ipc_rules_events_methods_t : public wf::per_output_tracker_mixin_t<>
             return wf::ipc::json_error("Event list is not an array!");
         }
 
+        // Maximum number of high-frequency events (view-geometry-changed) per view and second.
+        auto max_rate = wf::ipc::json_get_optional_uint64(data, "max-rate");
+        if (max_rate.has_value() && (max_rate.value() == 0))
+        {
+            return wf::ipc::json_error("max-rate must be positive!");
+        }
+
         if (clients.count(client))
         {
             return wf::ipc::json_error("Client is already watching events!");
         }
 
         client_watch_state_t state;
+        if (max_rate.has_value())
+        {
+            state.min_geometry_interval = 1000 / std::min<uint64_t>(max_rate.value(), 1000);
+        }
+
         if (data.has_member(EVENTS))
         {
             for (size_t i = 0; i < data[EVENTS].size(); i++)
@@ -245,16 +298,192 @@ class ipc_rules_events_methods_t : public wf::per_output_tracker_mixin_t<>
     void send_event_to_subscribes(const wf::json_t& data, const std::string& event_name,
         bool custom_event = false)
     {
+        // Keep events in order: geometry changes which happened before this event are sent first.
+        flush_geometry_events();
+
+        // Serialize the event only once, and only if somebody is listening for it
+        std::shared_ptr<const std::string> serialized;
+        for (auto& [client, state] : clients)
+        {
+            if (state.is_subscribed(event_name, custom_event))
+            {
+                if (!serialized)
+                {
+                    serialized = wf::ipc::serialize_json(data);
+                }
+
+                // Rate-limited geometry changes happened before this event, so they are sent first.
+                send_postponed_geometry(client, state, true);
+                client->send_serialized(serialized);
+            }
+        }
+    }
+
+    /* ------------------------- Geometry event coalescing ----------------------------
+     * view-geometry-changed can be emitted many times per frame (e.g. when moving a view with the pointer).
+     * Instead of sending each change, we remember the first old geometry of each changed view, and send a
+     * single event per view with the current state once per frame. Clients can additionally limit the rate
+     * of geometry events with the max-rate parameter of window-rules/events/watch. */
+    static constexpr const char *GEOMETRY_EVENT = "view-geometry-changed";
+
+    // If no output repaints, pending geometry events are sent after this timeout.
+    static constexpr int GEOMETRY_FLUSH_TIMEOUT = 50;
+
+    // View id -> old geometry of all views whose geometry changed since the last frame, in order
+    std::vector<std::pair<uint32_t, wf::geometry_t>> pending_geometry;
+    wf::wl_timer<false> geometry_flush_timer;
+
+    static wf::json_t geometry_event_to_json(wayfire_view view, wf::geometry_t old_geometry)
+    {
+        wf::json_t data;
+        data["event"] = GEOMETRY_EVENT;
+        data["old-geometry"] = wf::ipc::geometry_to_json(old_geometry);
+        data["view"] = ipc_rules::view_to_json(view);
+        return data;
+    }
+
+    void flush_geometry_events()
+    {
+        if (pending_geometry.empty())
+        {
+            return;
+        }
+
+        auto events = std::move(pending_geometry);
+        pending_geometry.clear();
+        geometry_flush_timer.disconnect();
+
+        const int64_t now = wf::get_current_time();
+        for (auto& [id, old_geometry] : events)
+        {
+            auto view = wf::ipc::find_view_by_id(id);
+            if (!view)
+            {
+                continue;
+            }
+
+            std::shared_ptr<const std::string> serialized;
+            for (auto& [client, state] : clients)
+            {
+                if (!state.is_subscribed(GEOMETRY_EVENT, false))
+                {
+                    continue;
+                }
+
+                if (state.min_geometry_interval > 0)
+                {
+                    // Events of other views postponed earlier have to be sent first, to keep the order.
+                    if (!state.postponed_geometry.empty() || (now < state.next_geometry_event_allowed(id)))
+                    {
+                        postpone_geometry_event(client, state, id, old_geometry);
+                        continue;
+                    }
+
+                    state.last_geometry_event[id] = now;
+                }
+
+                if (!serialized)
+                {
+                    serialized = wf::ipc::serialize_json(geometry_event_to_json(view, old_geometry));
+                }
+
+                client->send_serialized(serialized);
+            }
+        }
+
         for (auto& [client, state] : clients)
         {
-            if (state.connected_events.empty() || state.connected_events.count(event_name) ||
-                (custom_event && state.connected_all))
+            state.expire_geometry_rate_limits(now);
+        }
+    }
+
+    void postpone_geometry_event(wf::ipc::client_interface_t *client, client_watch_state_t& state,
+        uint32_t id, wf::geometry_t old_geometry)
+    {
+        auto& postponed = state.postponed_geometry;
+        auto it = std::find_if(postponed.begin(), postponed.end(),
+            [&] (const auto& event) { return event.first == id; });
+        if (it == postponed.end())
+        {
+            // Keep the oldest geometry, the current one is read when the event is sent
+            postponed.emplace_back(id, old_geometry);
+        }
+
+        schedule_postponed_geometry(client, state);
+    }
+
+    void schedule_postponed_geometry(wf::ipc::client_interface_t *client, client_watch_state_t& state)
+    {
+        if (state.postponed_geometry.empty() || state.rate_limit_timer->is_connected())
+        {
+            return;
+        }
+
+        const int64_t delay = state.next_geometry_event_allowed(state.postponed_geometry.front().first) -
+            wf::get_current_time();
+        state.rate_limit_timer->set_timeout(std::max<int64_t>(delay, 1), [=] ()
+        {
+            auto it = clients.find(client);
+            if (it != clients.end())
+            {
+                send_postponed_geometry(client, it->second, false);
+            }
+        });
+    }
+
+    /**
+     * Send the postponed geometry events of a client in order, until the first one which is still
+     * rate-limited, or all of them if @force is set.
+     */
+    void send_postponed_geometry(wf::ipc::client_interface_t *client, client_watch_state_t& state,
+        bool force)
+    {
+        auto& postponed = state.postponed_geometry;
+        if (postponed.empty())
+        {
+            return;
+        }
+
+        const int64_t now = wf::get_current_time();
+        size_t sent = 0;
+        for (; sent < postponed.size(); sent++)
+        {
+            auto& [id, old_geometry] = postponed[sent];
+            if (!force && (now < state.next_geometry_event_allowed(id)))
+            {
+                break;
+            }
+
+            state.last_geometry_event[id] = now;
+            if (auto view = wf::ipc::find_view_by_id(id))
             {
-                client->send_json(data);
+                client->send_json(geometry_event_to_json(view, old_geometry));
             }
         }
+
+        postponed.erase(postponed.begin(), postponed.begin() + sent);
+        if (postponed.empty())
+        {
+            state.rate_limit_timer->disconnect();
+        } else if (!state.rate_limit_timer->is_connected())
+        {
+            // We may be running from the timer itself, which cannot be rearmed from its own callback.
+            state.rate_limit_idle->run_once([=] ()
+            {
+                auto it = clients.find(client);
+                if (it != clients.end())
+                {
+                    schedule_postponed_geometry(client, it->second);
+                }
+            });
+        }
     }
 
+    wf::signal::connection_t<wf::frame_done_signal> on_frame_done = [=] (wf::frame_done_signal *ev)
+    {
+        flush_geometry_events();
+    };
+
     wf::signal::connection_t<wf::view_mapped_signal> on_view_mapped = [=] (wf::view_mapped_signal *ev)
     {
         send_view_to_subscribes(ev->view, "view-mapped");
@@ -334,11 +563,23 @@ class ipc_rules_events_methods_t : public wf::per_output_tracker_mixin_t<>
     wf::signal::connection_t<wf::view_geometry_changed_signal> on_view_geometry_changed =
         [=] (wf::view_geometry_changed_signal *ev)
     {
-        wf::json_t data;
-        data["event"] = "view-geometry-changed";
-        data["old-geometry"] = wf::ipc::geometry_to_json(ev->old_geometry);
-        data["view"] = ipc_rules::view_to_json(ev->view);
-        send_event_to_subscribes(data, data["event"]);
+        const uint32_t id = ev->view->get_id();
+        auto it = std::find_if(pending_geometry.begin(), pending_geometry.end(),
+            [&] (const auto& pending) { return pending.first == id; });
+        if (it != pending_geometry.end())
+        {
+            // Coalesce with the previous change in this frame
+            return;
+        }
+
+        pending_geometry.emplace_back(id, ev->old_geometry);
+        if (!geometry_flush_timer.is_connected())
+        {
+            geometry_flush_timer.set_timeout(GEOMETRY_FLUSH_TIMEOUT, [=] ()
+            {
+                flush_geometry_events();
+            });
+        }
     };
 
     wf::signal::connection_t<wf::view_moved_to_wset_signal> on_view_moved_to_wset =
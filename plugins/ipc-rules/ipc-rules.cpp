@@ -70,7 +70,7 @@ class ipc_rules_t : public wf::plugin_interface_t,
     wf::ipc::method_callback list_views = [=] (wf::json_t)
     {
         wf::json_t response = wf::json_t::array();
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             wf::json_t v = wf::ipc_rules::view_to_json(view);
             response.append(v);
@@ -5,9 +5,11 @@
 #include "wayfire/debug.hpp"
 #include "wayfire/signal-definitions.hpp"
 #include <set>
+#include <algorithm>
 #include <wayfire/plugin.hpp>
 #include <wayfire/nonstd/wlroots-full.hpp>
 #include <wayfire/output-layout.hpp>
+#include <wayfire/render-manager.hpp>
 #include <wayfire/config/compound-option.hpp>
 #include <wayfire/config/config-manager.hpp>
 
@@ -35,6 +37,8 @@ class ipc_rules_utility_methods_t
         method_repository->register_method("wayfire/set-config-options", set_config_options);
         method_repository->register_method("wayfire/get-keyboard-state", get_kb_state);
         method_repository->register_method("wayfire/set-keyboard-state", set_kb_state);
+        method_repository->register_method("wayfire/get-frame-timings", get_frame_timings);
+        method_repository->register_method("wayfire/list-throttled-surfaces", list_throttled_surfaces);
     }
 
     void fini_utility_methods(ipc::method_repository_t *method_repository)
@@ -47,6 +51,8 @@ class ipc_rules_utility_methods_t
         method_repository->unregister_method("wayfire/set-config-option");
         method_repository->unregister_method("wayfire/get-keyboard-state");
         method_repository->unregister_method("wayfire/set-keyboard-state");
+        method_repository->unregister_method("wayfire/get-frame-timings");
+        method_repository->unregister_method("wayfire/list-throttled-surfaces");
     }
 
     wf::ipc::method_callback get_wayfire_configuration_info = [=] (wf::json_t)
@@ -373,5 +379,169 @@ class ipc_rules_utility_methods_t
             keyboard->modifiers.latched, keyboard->modifiers.locked, index);
         return wf::ipc::json_ok();
     };
+
+    /**
+     * Summarize the values of a single frame phase (in microseconds) as average, p50, p99 and max.
+     */
+    static wf::json_t summarize_phase(const std::vector<frame_timing_t>& frames,
+        int64_t frame_timing_t::*phase)
+    {
+        std::vector<int64_t> values;
+        values.reserve(frames.size());
+        int64_t sum = 0;
+        for (auto& frame : frames)
+        {
+            values.push_back(frame.*phase);
+            sum += frame.*phase;
+        }
+
+        wf::json_t summary;
+        if (values.empty())
+        {
+            summary["avg"] = 0;
+            summary["p50"] = 0;
+            summary["p99"] = 0;
+            summary["max"] = 0;
+            return summary;
+        }
+
+        std::sort(values.begin(), values.end());
+        auto percentile = [&] (int p)
+        {
+            return values[std::min(values.size() - 1, values.size() * p / 100)];
+        };
+
+        summary["avg"] = sum / (int64_t)values.size();
+        summary["p50"] = percentile(50);
+        summary["p99"] = percentile(99);
+        summary["max"] = values.back();
+        return summary;
+    }
+
+    static wf::json_t frame_statistics_to_json(wf::output_t *wo, bool include_frames)
+    {
+        static const std::vector<std::pair<std::string, int64_t frame_timing_t::*>> phases = {
+            {"effects-pre", &frame_timing_t::effects_pre},
+            {"effects-damage", &frame_timing_t::effects_damage},
+            {"render", &frame_timing_t::render},
+            {"effects-overlay", &frame_timing_t::effects_overlay},
+            {"submit", &frame_timing_t::submit},
+            {"postprocessing", &frame_timing_t::postprocessing},
+            {"sw-cursors", &frame_timing_t::sw_cursors},
+            {"swap", &frame_timing_t::swap},
+            {"effects-post", &frame_timing_t::effects_post},
+            {"total", &frame_timing_t::total},
+        };
+
+        auto stats = wo->render->get_frame_statistics();
+        wf::json_t result;
+        result["output-id"]     = wo->get_id();
+        result["output-name"]   = wo->to_string();
+        result["painted"]       = stats.painted_frames;
+        result["scanout"]       = stats.scanout_frames;
+        result["skipped"]       = stats.skipped_frames;
+        result["missed"]        = stats.missed_frames;
+        result["repaint-delay"] = stats.repaint_delay;
+        result["sampled"]       = (uint64_t)stats.frames.size();
+        result["damage-rects"]  = stats.damage_rects;
+        result["simplified-damage-rects"] = stats.simplified_damage_rects;
+        result["fused-transformer-passes"] = stats.fused_transformer_passes;
+
+        wf::json_t phases_json;
+        for (auto& [name, phase] : phases)
+        {
+            phases_json[name] = summarize_phase(stats.frames, phase);
+        }
+
+        result["phases"] = phases_json;
+        if (include_frames)
+        {
+            wf::json_t frames_json = wf::json_t::array();
+            for (auto& frame : stats.frames)
+            {
+                wf::json_t frame_json;
+                for (auto& [name, phase] : phases)
+                {
+                    frame_json[name] = frame.*phase;
+                }
+
+                frame_json["repaint-delay"] = frame.repaint_delay;
+                frame_json["damage-rects"]  = frame.damage_rects;
+                frame_json["simplified-damage-rects"] = frame.simplified_damage_rects;
+                frame_json["fused-transformer-passes"] = frame.fused_transformer_passes;
+                frames_json.append(frame_json);
+            }
+
+            result["frames"] = frames_json;
+        }
+
+        return result;
+    }
+
+    wf::ipc::method_callback get_frame_timings = [=] (const wf::json_t& data) -> json_t
+    {
+        auto output_id = wf::ipc::json_get_optional_uint64(data, "output-id");
+        auto include_frames = wf::ipc::json_get_optional_bool(data, "include-frames").value_or(false);
+
+        wf::json_t outputs = wf::json_t::array();
+        if (output_id.has_value())
+        {
+            auto wo = wf::ipc::find_output_by_id(output_id.value());
+            if (!wo)
+            {
+                return wf::ipc::json_error("Output not found!");
+            }
+
+            outputs.append(frame_statistics_to_json(wo, include_frames));
+        } else
+        {
+            for (auto& wo : wf::get_core().output_layout->get_outputs())
+            {
+                outputs.append(frame_statistics_to_json(wo, include_frames));
+            }
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["outputs"] = outputs;
+        return response;
+    };
+
+    static int count_throttled_surfaces(wf::scene::node_ptr root)
+    {
+        int count = 0;
+        if (auto surface = dynamic_cast<wf::scene::wlr_surface_node_t*>(root.get()))
+        {
+            count += surface->is_throttled() ? 1 : 0;
+        }
+
+        for (auto& child : root->get_children())
+        {
+            count += count_throttled_surfaces(child);
+        }
+
+        return count;
+    }
+
+    wf::ipc::method_callback list_throttled_surfaces = [=] (const wf::json_t&)
+    {
+        wf::json_t views = wf::json_t::array();
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
+        {
+            const int count = count_throttled_surfaces(view->get_surface_root_node());
+            if (count > 0)
+            {
+                wf::json_t v;
+                v["id"]     = view->get_id();
+                v["app-id"] = view->get_app_id();
+                v["title"]  = view->get_title();
+                v["throttled-surfaces"] = count;
+                views.append(v);
+            }
+        }
+
+        auto response = wf::ipc::json_ok();
+        response["views"] = views;
+        return response;
+    };
 };
 }
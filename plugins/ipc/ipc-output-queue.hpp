@@ -0,0 +1,73 @@
+#pragma once
+
+#include <sys/uio.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace wf
+{
+namespace ipc
+{
+/**
+ * A message waiting to be written to an IPC client.
+ */
+struct queued_message_t
+{
+    uint32_t header;
+    /* The serialized message, possibly shared with other clients. */
+    std::shared_ptr<const std::string> payload;
+
+    size_t size() const
+    {
+        return sizeof(header) + payload->size();
+    }
+};
+
+/**
+ * Fill @iov with the data of the queued messages which has not been written yet, so that it can be written
+ * with a single sendmsg() call.
+ *
+ * @param queue The messages to write.
+ * @param offset The number of bytes of the first message (header included) which were already written.
+ * @param iov The array to fill.
+ * @param max_iov The size of @iov.
+ *
+ * @return The number of entries of @iov which were filled.
+ */
+inline size_t fill_output_iov(const std::deque<queued_message_t>& queue, size_t offset,
+    iovec *iov, size_t max_iov)
+{
+    size_t n    = 0;
+    size_t skip = offset;
+    for (auto it = queue.begin(); it != queue.end(); ++it)
+    {
+        // Each message needs up to two entries, header and payload.
+        const bool needs_header = skip < sizeof(it->header);
+        if (n + (needs_header ? 2 : 1) > max_iov)
+        {
+            break;
+        }
+
+        if (needs_header)
+        {
+            iov[n].iov_base = (char*)&it->header + skip;
+            iov[n].iov_len  = sizeof(it->header) - skip;
+            ++n;
+            skip = 0;
+        } else
+        {
+            skip -= sizeof(it->header);
+        }
+
+        iov[n].iov_base = (void*)(it->payload->data() + skip);
+        iov[n].iov_len  = it->payload->size() - skip;
+        ++n;
+        skip = 0;
+    }
+
+    return n;
+}
+}
+}
@@ -7,7 +7,7 @@
 
 #include <fcntl.h>
 #include <sys/socket.h>
-#include <sys/ioctl.h>
+#include <sys/uio.h>
 #include <unistd.h>
 #include <cstring>
 
@@ -145,8 +145,24 @@ int wl_loop_handle_ipc_client_fd_event(int, uint32_t mask, void *data)
     return 0;
 }
 
-static constexpr int MAX_MESSAGE_LEN = (1 << 20);
-static constexpr int HEADER_LEN = 4;
+static constexpr size_t MAX_MESSAGE_LEN = (1 << 20);
+static constexpr size_t HEADER_LEN = 4;
+static constexpr size_t INITIAL_BUFFER_LEN = (1 << 16);
+
+/**
+ * If more than this many bytes are waiting to be written to a client, we stop handling its requests until
+ * it reads its replies.
+ */
+static constexpr size_t MAX_PENDING_OUTPUT = (16 << 20);
+
+/**
+ * If more than this many bytes are waiting to be written to a client (e.g. because it subscribed to events
+ * but does not read them), the client is disconnected.
+ */
+static constexpr size_t MAX_QUEUED_OUTPUT = (64 << 20);
+
+/** The maximum number of messages written with a single sendmsg() call. */
+static constexpr size_t MAX_IOV = 64;
 
 wf::ipc::client_t::client_t(server_t *ipc, int fd)
 {
@@ -156,132 +172,144 @@ wf::ipc::client_t::client_t(server_t *ipc, int fd)
     this->ipc = ipc;
 
     auto ev_loop = wf::get_core().ev_loop;
-    source = wl_event_loop_add_fd(ev_loop, fd, WL_EVENT_READABLE,
+    this->event_mask = WL_EVENT_READABLE;
+    source = wl_event_loop_add_fd(ev_loop, fd, event_mask,
         wl_loop_handle_ipc_client_fd_event, &this->handle_fd_activity);
 
-    // +1 for null byte at the end
-    buffer.resize(MAX_MESSAGE_LEN + 1);
+    // The buffer grows as needed, up to MAX_MESSAGE_LEN
+    buffer.resize(INITIAL_BUFFER_LEN);
     this->handle_fd_activity = [=] (uint32_t event_mask)
     {
         handle_fd_incoming(event_mask);
     };
 }
 
-// -1 error, 0 success, 1 try again later
-int wf::ipc::client_t::read_up_to(int n, int *available)
+bool wf::ipc::client_t::read_incoming()
 {
-    int need = n - current_buffer_valid;
-    int want = std::min(need, *available);
+    if ((buffer_valid == buffer.size()) && (buffer.size() < MAX_MESSAGE_LEN))
+    {
+        buffer.resize(std::min(buffer.size() * 2, MAX_MESSAGE_LEN));
+    }
 
-    while (want > 0)
+    if (buffer_valid == buffer.size())
     {
-        int r = read(fd, buffer.data() + current_buffer_valid, want);
-        if (r <= 0)
+        // Buffer is full of messages we have not handled yet
+        return true;
+    }
+
+    ssize_t r = read(fd, buffer.data() + buffer_valid, buffer.size() - buffer_valid);
+    if (r < 0)
+    {
+        if ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR))
         {
-            LOGI("Read: EOF or error (%d) %s\n", r, strerror(errno));
-            return -1;
+            return true;
         }
 
-        want -= r;
-        *available -= r;
-        current_buffer_valid += r;
+        LOGI("Read: error (", r, ") ", strerror(errno));
+        return false;
     }
 
-    if (current_buffer_valid < n)
+    if (r == 0)
     {
-        // didn't read all n bytes
-        return 1;
+        LOGD("Read: EOF");
+        return false;
     }
 
-    return 0;
+    buffer_valid += r;
+    return true;
 }
 
-void wf::ipc::client_t::handle_fd_incoming(uint32_t event_mask)
+bool wf::ipc::client_t::process_messages()
 {
-    if (event_mask & (WL_EVENT_ERROR | WL_EVENT_HANGUP))
+    size_t offset = 0;
+    while ((buffer_valid - offset >= HEADER_LEN) && (output_queued_bytes < MAX_PENDING_OUTPUT))
     {
-        ipc->client_disappeared(this);
-        // this no longer exists
-        return;
-    }
-
-    int available = 0;
-    if (ioctl(this->fd, FIONREAD, &available) != 0)
-    {
-        LOGE("Failed to inspect message buffer!");
-        ipc->client_disappeared(this);
-        return;
-    }
-
-    while (available > 0)
-    {
-        if (current_buffer_valid < HEADER_LEN)
-        {
-            if (read_up_to(HEADER_LEN, &available) < 0)
-            {
-                ipc->client_disappeared(this);
-                return;
-            }
-
-            continue;
-        }
-
-        const uint32_t len = *((uint32_t*)buffer.data());
+        uint32_t len;
+        std::memcpy(&len, buffer.data() + offset, HEADER_LEN);
         if (len > MAX_MESSAGE_LEN - HEADER_LEN)
         {
             LOGE("Client tried to pass too long a message!");
             ipc->client_disappeared(this);
-            return;
-        }
-
-        const int next_target = HEADER_LEN + len;
-        int r = read_up_to(next_target, &available);
-        if (r < 0)
-        {
-            ipc->client_disappeared(this);
-            return;
+            return false;
         }
 
-        if (r > 0)
+        if (buffer_valid - offset < HEADER_LEN + len)
         {
-            // Try again
-            continue;
+            // Message not fully received yet
+            break;
         }
 
-        // Finally, received the message, make sure we have a terminating NULL byte
-        buffer[current_buffer_valid] = '\0';
-        char *str = buffer.data() + HEADER_LEN;
+        std::string_view str{buffer.data() + offset + HEADER_LEN, len};
+        offset += HEADER_LEN + len;
 
         json_t message;
-        auto err = json_t::parse_string(std::string_view{str, len}, message);
+        auto err = json_t::parse_string(str, message);
         if (err.has_value())
         {
             json_t error;
             error["error"] = std::string("Client's message could not be parsed, error: ") + *err;
-            LOGE((std::string)error["error"], ": ", str);
+            LOGE((std::string)error["error"], ": ", std::string{str});
             this->send_json(error);
+            flush_output();
             ipc->client_disappeared(this);
-            return;
+            return false;
         }
 
         if (!message.has_member("method") || !message["method"].is_string())
         {
-            LOGI("Start");
             json_t error;
             error["error"] = "Client's message does not contain a method to be called!";
-            LOGI("MID");
             LOGE(error["error"].as_string());
-            LOGI("END");
 
             this->send_json(error);
+            flush_output();
             ipc->client_disappeared(this);
-            return;
+            return false;
         }
 
         ipc->handle_incoming_message(this, std::move(message));
-        // Reset for next message
-        current_buffer_valid = 0;
     }
+
+    // Move the remaining (incomplete or not yet handled) messages to the beginning of the buffer
+    if (offset > 0)
+    {
+        std::memmove(buffer.data(), buffer.data() + offset, buffer_valid - offset);
+        buffer_valid -= offset;
+    }
+
+    return true;
+}
+
+void wf::ipc::client_t::handle_fd_incoming(uint32_t event_mask)
+{
+    if (event_mask & (WL_EVENT_ERROR | WL_EVENT_HANGUP))
+    {
+        ipc->client_disappeared(this);
+        // this no longer exists
+        return;
+    }
+
+    if ((event_mask & WL_EVENT_WRITABLE) && !flush_output())
+    {
+        LOGE("Error sending json to client!");
+        ipc->client_disappeared(this);
+        return;
+    }
+
+    if ((event_mask & WL_EVENT_READABLE) && !read_incoming())
+    {
+        ipc->client_disappeared(this);
+        return;
+    }
+
+    // Handle all pipelined requests we have received so far. This also resumes handling of requests which
+    // were postponed because the client did not read its replies.
+    if (!process_messages())
+    {
+        return;
+    }
+
+    update_event_mask();
 }
 
 wf::ipc::client_t::~client_t()
@@ -291,49 +319,160 @@ wf::ipc::client_t::~client_t()
     close(this->fd);
 }
 
-static bool write_exact(int fd, const char *buf, ssize_t n)
+/**
+ * Write the given buffers to the socket without blocking.
+ * @return The number of bytes written, or -1 on error.
+ */
+static ssize_t write_nonblock(int fd, iovec *iov, size_t n)
 {
-    while (n > 0)
+    msghdr msg;
+    std::memset(&msg, 0, sizeof(msg));
+    msg.msg_iov    = iov;
+    msg.msg_iovlen = n;
+
+    ssize_t w = sendmsg(fd, &msg, MSG_NOSIGNAL);
+    if ((w < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == EINTR)))
     {
-        ssize_t w = write(fd, buf, n);
-        if (w <= 0)
+        return 0;
+    }
+
+    return w;
+}
+
+bool wf::ipc::client_t::flush_output()
+{
+    while (!output_queue.empty())
+    {
+        iovec iov[2 * MAX_IOV];
+        const size_t n = fill_output_iov(output_queue, output_offset, iov, 2 * MAX_IOV);
+        ssize_t w = write_nonblock(fd, iov, n);
+        if (w < 0)
         {
             return false;
         }
 
-        n   -= w;
-        buf += w;
+        if (w == 0)
+        {
+            // Socket is full, wait for WL_EVENT_WRITABLE
+            break;
+        }
+
+        size_t written = w;
+        while (written > 0)
+        {
+            const size_t remaining = output_queue.front().size() - output_offset;
+            if (written < remaining)
+            {
+                output_offset += written;
+                break;
+            }
+
+            written -= remaining;
+            output_queued_bytes -= output_queue.front().size();
+            output_queue.pop_front();
+            output_offset = 0;
+        }
     }
 
     return true;
 }
 
-bool wf::ipc::client_t::send_json(wf::json_t json)
+void wf::ipc::client_t::update_event_mask()
 {
-    bool status = false;
-    json.map_serialized([&] (const char *buffer, size_t size)
+    uint32_t mask = 0;
+    if (output_queued_bytes < MAX_PENDING_OUTPUT)
     {
-        if (size > MAX_MESSAGE_LEN)
+        mask |= WL_EVENT_READABLE;
+    }
+
+    if (!output_queue.empty())
+    {
+        mask |= WL_EVENT_WRITABLE;
+    }
+
+    if (mask != event_mask)
+    {
+        event_mask = mask;
+        wl_event_source_fd_update(source, mask);
+    }
+}
+
+bool wf::ipc::client_t::send_buffer(const char *buffer, size_t size,
+    std::shared_ptr<const std::string> shared)
+{
+    if (size > MAX_MESSAGE_LEN)
+    {
+        LOGE("Error sending json to client: message too long!");
+        shutdown(fd, SHUT_RDWR);
+        return false;
+    }
+
+    if (output_queued_bytes + HEADER_LEN + size > MAX_QUEUED_OUTPUT)
+    {
+        LOGE("IPC client is not reading its messages, disconnecting it.");
+        shutdown(fd, SHUT_RDWR);
+        return false;
+    }
+
+    uint32_t len = size;
+    size_t written = 0;
+    if (output_queue.empty())
+    {
+        // Fast path: write directly from the serialized buffer, without copying
+        iovec iov[2];
+        iov[0].iov_base = &len;
+        iov[0].iov_len  = HEADER_LEN;
+        iov[1].iov_base = (void*)buffer;
+        iov[1].iov_len  = size;
+
+        ssize_t w = write_nonblock(fd, iov, 2);
+        if (w < 0)
         {
-            LOGE("Error sending json to client: message too long!");
+            LOGE("Error sending json to client!");
             shutdown(fd, SHUT_RDWR);
-            return;
+            return false;
         }
 
-        uint32_t len = size;
-        if (!write_exact(fd, (char*)&len, 4) || !write_exact(fd, buffer, len))
+        written = w;
+    }
+
+    if (written < HEADER_LEN + size)
+    {
+        // The socket is full, queue the rest for when the client reads its messages
+        if (!shared)
         {
-            LOGE("Error sending json to client!");
-            shutdown(fd, SHUT_RDWR);
-            return;
+            shared = std::make_shared<std::string>(buffer, size);
         }
 
-        status = true;
+        if (output_queue.empty())
+        {
+            output_offset = written;
+        }
+
+        output_queue.push_back({len, std::move(shared)});
+        output_queued_bytes += output_queue.back().size();
+        update_event_mask();
+    }
+
+    return true;
+}
+
+bool wf::ipc::client_t::send_json(wf::json_t json)
+{
+    bool status = false;
+    json.map_serialized([&] (const char *buffer, size_t size)
+    {
+        status = send_buffer(buffer, size, nullptr);
     });
 
     return status;
 }
 
+bool wf::ipc::client_t::send_serialized(std::shared_ptr<const std::string> message)
+{
+    return send_buffer(message->data(), message->size(), message);
+}
+
 namespace wf
 {
 class ipc_plugin_t : public wf::plugin_interface_t
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <deque>
+#include <memory>
 #include <sys/un.h>
 #include <wayfire/object.hpp>
 #include <wayland-server.h>
 #include <wayfire/plugins/common/shared-core-data.hpp>
 #include "wayfire/plugins/ipc/ipc-method-repository.hpp"
+#include "ipc-output-queue.hpp"
 
 namespace wf
 {
@@ -20,15 +23,51 @@ class client_t : public client_interface_t
     client_t(server_t *server, int client_fd);
     ~client_t();
     bool send_json(wf::json_t json) override;
+    bool send_serialized(std::shared_ptr<const std::string> message) override;
 
   private:
     int fd;
     wl_event_source *source;
     server_t *ipc;
+    uint32_t event_mask = 0;
 
-    int current_buffer_valid = 0;
+    /** Data received from the client which has not been processed yet. */
     std::vector<char> buffer;
-    int read_up_to(int n, int *available);
+    size_t buffer_valid = 0;
+
+    /**
+     * Read as much data as fits in the buffer.
+     * @return false if the client should be disconnected.
+     */
+    bool read_incoming();
+
+    /**
+     * Handle all complete messages in the buffer, unless the client does not read its replies fast
+     * enough.
+     * @return false if the client was disconnected (and destroyed).
+     */
+    bool process_messages();
+
+    /**
+     * Messages which could not be written to the socket yet.
+     * The first output_offset bytes (header included) of the first message have already been written.
+     */
+    std::deque<queued_message_t> output_queue;
+    size_t output_offset = 0;
+    size_t output_queued_bytes = 0;
+
+    /**
+     * Send the given message. If it cannot be written immediately, it is added to the output queue,
+     * reusing @shared if it is set, or copying @buffer otherwise.
+     */
+    bool send_buffer(const char *buffer, size_t size, std::shared_ptr<const std::string> shared);
+
+    /**
+     * Write as much of the output queue as the socket accepts without blocking.
+     * @return false if writing failed.
+     */
+    bool flush_output();
+    void update_event_mask();
 
     /** Handle incoming data on the socket */
     std::function<void(uint32_t)> handle_fd_activity;
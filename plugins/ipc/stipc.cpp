@@ -316,7 +316,6 @@ class stipc_plugin_t : public wf::plugin_interface_t
 
     ipc::method_callback layout_views = [] (wf::json_t data) -> wf::json_t
     {
-        auto views = wf::get_core().get_all_views();
         if (!data.has_member("views") || !data["views"].is_array())
         {
             return wf::ipc::json_error("Views not specified");
@@ -332,18 +331,14 @@ class stipc_plugin_t : public wf::plugin_interface_t
             int height  = wf::ipc::json_get_int64(v, "height");
             auto output = wf::ipc::json_get_optional_string(v, "output");
 
-            auto it = std::find_if(views.begin(), views.end(), [&] (auto& view)
-            {
-                return view->get_id() == uint64_t(v["id"]);
-            });
-
-            if (it == views.end())
+            auto view = wf::ipc::find_view_by_id(id);
+            if (!view)
             {
                 return wf::ipc::json_error("Could not find view with id " +
                     std::to_string(id));
             }
 
-            auto toplevel = toplevel_cast(*it);
+            auto toplevel = toplevel_cast(view);
             if (!toplevel)
             {
                 return wf::ipc::json_error("View is not toplevel view id " +
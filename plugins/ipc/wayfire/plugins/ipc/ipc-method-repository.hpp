@@ -2,6 +2,7 @@
 
 #include <functional>
 #include <map>
+#include <memory>
 #include "wayfire/signal-provider.hpp"
 #include <wayfire/nonstd/json.hpp>
 #include <string>
@@ -30,9 +31,40 @@ class client_interface_t
 {
   public:
     virtual bool send_json(json_t json) = 0;
+
+    /**
+     * Send an already serialized JSON message to the client.
+     * This allows sending the same message to many clients (e.g. events) while serializing it only once.
+     * The message buffer may be retained by the client until it has been sent.
+     */
+    virtual bool send_serialized(std::shared_ptr<const std::string> message)
+    {
+        json_t json;
+        if (json_t::parse_string(*message, json).has_value())
+        {
+            return false;
+        }
+
+        return send_json(std::move(json));
+    }
+
     virtual ~client_interface_t() = default;
 };
 
+/**
+ * Serialize the given JSON object into a buffer which can be passed to client_interface_t::send_serialized().
+ */
+inline std::shared_ptr<const std::string> serialize_json(const json_t& json)
+{
+    auto message = std::make_shared<std::string>();
+    json.map_serialized([&] (const char *buffer, size_t size)
+    {
+        message->assign(buffer, size);
+    });
+
+    return message;
+}
+
 /**
  * A signal emitted on the ipc method repository when a client disconnects.
  */
@@ -129,6 +161,40 @@ class method_repository_t : public wf::signal::provider_t
 
             return response;
         });
+
+        // Execute multiple method calls in a single request.
+        // The request data is {"requests": [{"method": ..., "data": ...}, ...]}, the response contains
+        // the result of each call, in order, in the "results" array.
+        register_method("batch", [this] (const wf::json_t& data, client_interface_t *client)
+        {
+            wf::json_t response;
+            if (!data.has_member("requests") || !data["requests"].is_array())
+            {
+                response["error"] = "Batch request does not contain a list of requests!";
+                return response;
+            }
+
+            const auto& requests = data["requests"];
+            response["results"] = wf::json_t::array();
+            for (size_t i = 0; i < requests.size(); i++)
+            {
+                const auto& request = requests[i];
+                if (!request.has_member("method") || !request["method"].is_string() ||
+                    (request["method"].as_string() == "batch"))
+                {
+                    wf::json_t error;
+                    error["error"] = "Batch request contains an entry without a valid method!";
+                    response["results"].append(error);
+                    continue;
+                }
+
+                wf::json_t request_data = request.has_member("data") ? request["data"] : wf::json_t{};
+                response["results"].append(call_method(request["method"].as_string(),
+                    std::move(request_data), client));
+            }
+
+            return response;
+        });
     }
 
   private:
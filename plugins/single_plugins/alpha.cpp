@@ -148,7 +148,7 @@ class wayfire_alpha : public wf::plugin_interface_t
 
     wf::config::option_base_t::updated_callback_t min_value_changed = [=] ()
     {
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             auto tmgr = view->get_transformed_node();
             auto transformer = tmgr->get_transformer<wf::scene::view_2d_transformer_t>("alpha");
@@ -162,7 +162,7 @@ class wayfire_alpha : public wf::plugin_interface_t
 
     void fini() override
     {
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             view->get_transformed_node()->rem_transformer("alpha");
         }
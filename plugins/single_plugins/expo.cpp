@@ -43,6 +43,8 @@ class wayfire_expo : public wf::per_output_plugin_instance_t, public wf::keyboar
     wf::option_wrapper_t<bool> keyboard_interaction{"expo/keyboard_interaction"};
     wf::option_wrapper_t<double> inactive_brightness{"expo/inactive_brightness"};
     wf::option_wrapper_t<int> transition_length{"expo/transition_length"};
+    wf::option_wrapper_t<bool> keep_thumbnails{"expo/keep_thumbnails"};
+    wf::option_wrapper_t<int> thumbnail_update_interval{"expo/thumbnail_update_interval"};
     wf::geometry_animation_t zoom_animation{zoom_duration};
 
     wf::option_wrapper_t<bool> move_enable_snap_off{"move/enable_snap_off"};
@@ -128,12 +130,20 @@ class wayfire_expo : public wf::per_output_plugin_instance_t, public wf::keyboar
 
         setup_workspace_bindings_from_config();
         wall = std::make_unique<wf::workspace_wall_t>(this->output);
+        update_thumbnail_cache();
+        keep_thumbnails.set_callback(update_thumbnail_cache);
+        thumbnail_update_interval.set_callback(update_thumbnail_cache);
 
         drag_helper->connect(&on_drag_output_focus);
         drag_helper->connect(&on_drag_snap_off);
         drag_helper->connect(&on_drag_done);
     }
 
+    wf::config::option_base_t::updated_callback_t update_thumbnail_cache = [=] ()
+    {
+        wall->set_thumbnail_cache(keep_thumbnails, thumbnail_update_interval);
+    };
+
     bool handle_toggle()
     {
         if (!state.active)
@@ -49,7 +49,7 @@ class wf_wrot : public wf::per_output_plugin_instance_t, public wf::pointer_inte
 
     void reset_all()
     {
-        for (auto v : wf::get_core().get_all_views())
+        for (auto v : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             v->get_transformed_node()->rem_transformer(transformer_2d);
             v->get_transformed_node()->rem_transformer(transformer_3d);
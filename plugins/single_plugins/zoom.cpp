@@ -3,6 +3,9 @@
 #include <wayfire/render.hpp>
 #include <wayfire/render-manager.hpp>
 #include <wayfire/util/duration.hpp>
+#include <wayfire/signal-definitions.hpp>
+#include <wayfire/core.hpp>
+#include <cmath>
 
 class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
 {
@@ -16,8 +19,10 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
     wf::option_wrapper_t<double> speed{"zoom/speed"};
     wf::option_wrapper_t<wf::animation_description_t> smoothing_duration{"zoom/smoothing_duration"};
     wf::option_wrapper_t<int> interpolation_method{"zoom/interpolation_method"};
+    wf::option_wrapper_t<bool> render_region_only{"zoom/render_region_only"};
     wf::animation::simple_animation_t progression{smoothing_duration};
-    bool hook_set = false;
+    bool hook_set   = false;
+    bool region_set = false;
 
     wf::plugin_activation_data_t grab_interface = {
         .name = "zoom",
@@ -41,7 +46,17 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
         {
             progression.animate(target);
 
-            if (!hook_set)
+            if (hook_set || region_set)
+            {
+                output->render->schedule_redraw();
+            } else if (render_region_only)
+            {
+                region_set = true;
+                output->render->add_effect(&update_render_region, wf::OUTPUT_EFFECT_PRE);
+                wf::get_core().connect(&on_motion);
+                wf::get_core().connect(&on_motion_absolute);
+                output->render->schedule_redraw();
+            } else
             {
                 hook_set = true;
                 output->render->add_post(&render_hook);
@@ -106,6 +121,65 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
         }
     };
 
+    /* The part of the output which is magnified, in output-local coordinates. */
+    wf::geometry_t get_zoomed_region(float factor)
+    {
+        auto og = output->get_relative_geometry();
+        auto oc = output->get_cursor_position();
+        double x, y;
+        wlr_box_closest_point(&og, oc.x, oc.y, &x, &y);
+
+        // Same as in the post hook, but rounded to whole logical pixels
+        const float scale = (factor - 1) / factor;
+        const int w = std::clamp((int)std::round(og.width / factor), 1, og.width);
+        const int h = std::clamp((int)std::ceil(1.0 * w * og.height / og.width), 1, og.height);
+        return {
+            std::clamp((int)std::round(x * scale), 0, og.width - w),
+            std::clamp((int)std::round(y * scale), 0, og.height - h),
+            w, h,
+        };
+    }
+
+    /* In render_region_only mode, the render manager renders only the zoomed region, at the resolution of
+     * the output. Compared to the post hook, nothing outside of the region is rendered, and damage outside
+     * of it does not cause repaints. */
+    wf::effect_hook_t update_render_region = [=] ()
+    {
+        const float factor = (float)progression;
+        if (!progression.running() && (factor - 1 <= 0.01))
+        {
+            unset_render_region();
+            return;
+        }
+
+        output->render->set_render_region(get_zoomed_region(factor));
+        if (progression.running())
+        {
+            output->render->schedule_redraw();
+        }
+    };
+
+    // The zoomed region follows the cursor
+    wf::signal::connection_t<wf::post_input_event_signal<wlr_pointer_motion_event>> on_motion = [=] (auto)
+    {
+        output->render->schedule_redraw();
+    };
+
+    wf::signal::connection_t<wf::post_input_event_signal<wlr_pointer_motion_absolute_event>>
+    on_motion_absolute = [=] (auto)
+    {
+        output->render->schedule_redraw();
+    };
+
+    void unset_render_region()
+    {
+        output->render->rem_effect(&update_render_region);
+        output->render->set_render_region({});
+        on_motion.disconnect();
+        on_motion_absolute.disconnect();
+        region_set = false;
+    }
+
     void unset_hook()
     {
         output->render->set_redraw_always(false);
@@ -120,6 +194,11 @@ class wayfire_zoom_screen : public wf::per_output_plugin_instance_t
             output->render->rem_post(&render_hook);
         }
 
+        if (region_set)
+        {
+            unset_render_region();
+        }
+
         output->rem_binding(&axis);
     }
 };
@@ -153,10 +153,22 @@ resize_view_controller_t::resize_view_controller_t(wf::workspace_set_t *wset, wa
         horizontal_pair = this->find_resizing_pair(true);
         vertical_pair   = this->find_resizing_pair(false);
     }
+
+    on_pre_frame = [=] ()
+    {
+        output->render->rem_effect(&on_pre_frame);
+        resize_scheduled = false;
+        apply_resize();
+    };
 }
 
 resize_view_controller_t::~resize_view_controller_t()
-{}
+{
+    if (resize_scheduled)
+    {
+        output->render->rem_effect(&on_pre_frame);
+    }
+}
 
 uint32_t resize_view_controller_t::calculate_resizing_edges(wf::point_t grab)
 {
@@ -293,13 +305,36 @@ void resize_view_controller_t::adjust_geometry(int32_t& x1, int32_t& len1,
 
 void resize_view_controller_t::input_motion()
 {
-    auto input = get_global_input_coordinates(output);
-    if (!this->grabbed_view)
+    if (!this->grabbed_view || resize_scheduled)
+    {
+        return;
+    }
+
+    resize_scheduled = true;
+    output->render->add_effect(&on_pre_frame, wf::OUTPUT_EFFECT_PRE);
+    output->render->schedule_redraw();
+}
+
+void resize_view_controller_t::input_released(bool force_stop)
+{
+    if (!resize_scheduled)
     {
         return;
     }
 
-    auto tx = wf::txn::transaction_t::create();
+    output->render->rem_effect(&on_pre_frame);
+    resize_scheduled = false;
+    if (!force_stop)
+    {
+        // Do not lose the last movement before the button was released
+        apply_resize();
+    }
+}
+
+void resize_view_controller_t::apply_resize()
+{
+    auto input = get_global_input_coordinates(output);
+    auto tx    = wf::txn::transaction_t::create();
     if (horizontal_pair.first && horizontal_pair.second)
     {
         int dy = input.y - last_point.y;
@@ -324,7 +359,11 @@ void resize_view_controller_t::input_motion()
         vertical_pair.second->set_geometry(g2, tx);
     }
 
-    wf::get_core().tx_manager->schedule_transaction(std::move(tx));
+    if (!tx->get_objects().empty())
+    {
+        wf::get_core().tx_manager->schedule_transaction(std::move(tx));
+    }
+
     this->last_point = input;
 }
 
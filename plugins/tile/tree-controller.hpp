@@ -4,6 +4,7 @@
 #include "tree.hpp"
 #include "wayfire/plugins/common/shared-core-data.hpp"
 #include <wayfire/option-wrapper.hpp>
+#include <wayfire/render-manager.hpp>
 #include <wayfire/plugins/common/move-drag-interface.hpp>
 
 /* Contains functions which are related to manipulating the tiling tree */
@@ -98,6 +99,7 @@ class resize_view_controller_t : public tile_controller_t
     ~resize_view_controller_t();
 
     void input_motion() override;
+    void input_released(bool force_stop) override;
 
   protected:
     wf::output_t *output;
@@ -105,6 +107,17 @@ class resize_view_controller_t : public tile_controller_t
     /** Last input event location */
     wf::point_t last_point;
 
+    /**
+     * Motion events can arrive much more often than the output is repainted,
+     * so the resizing is applied at most once per frame, right before the
+     * frame is painted, with the latest input position.
+     */
+    bool resize_scheduled = false;
+    wf::effect_hook_t on_pre_frame;
+
+    /** Resize the nodes according to the input movement since last_point. */
+    void apply_resize();
+
     /** Edges of the grabbed view that we're resizing */
     uint32_t resizing_edges;
     /** Calculate the resizing edges for the grabbing view. */
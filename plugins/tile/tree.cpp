@@ -489,11 +489,24 @@ void view_node_t::set_geometry(wf::geometry_t geometry, wf::txn::transaction_upt
         return;
     }
 
+    auto target = calculate_target_geometry();
+    const auto& pending   = view->toplevel()->pending();
+    const auto& committed = view->toplevel()->committed();
+    if ((pending.tiled_edges == TILED_EDGES_ALL) && (pending.geometry == target) &&
+        (pending.fullscreen == committed.fullscreen) && (pending.geometry == committed.geometry) &&
+        (pending.tiled_edges == committed.tiled_edges))
+    {
+        /* Nothing changed for this view, so there is no need to reconfigure
+         * it. This way, a layout change only touches the affected views.
+         * Pending changes made by others (for example fullscreen) still
+         * need a transaction to be applied. */
+        return;
+    }
+
     wf::get_core().default_wm->update_last_windowed_geometry(view);
     view->toplevel()->pending().tiled_edges = TILED_EDGES_ALL;
     tx->add_object(view->toplevel());
 
-    auto target = calculate_target_geometry();
     if (this->needs_crossfade() && (target != view->get_geometry()))
     {
         view->get_transformed_node()->rem_transformer(scale_transformer_name);
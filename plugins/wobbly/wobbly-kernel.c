@@ -0,0 +1,259 @@
+/*
+ * Copyright © 2005 Novell, Inc.
+ * Copyright © 2014 Scott Moreau
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * Novell, Inc. not be used in advertising or publicity pertaining to
+ * distribution of the software without specific, written prior permission.
+ * Novell, Inc. makes no representations about the suitability of this
+ * software for any purpose. It is provided "as is" without express or
+ * implied warranty.
+ */
+
+/*
+ * Spring model implemented by Kristian Hogsberg.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "wobbly-kernel.h"
+
+/*
+ * Scalar implementation, which does the operations in exactly the same order
+ * as the original per-object model.
+ */
+static void springExertForces(struct wobbly_objects *o, float *fx, float *fy,
+    int a, int b, float offsetX, float offsetY, float k)
+{
+    float dax = 0.5f * (WOBBLY_X(o, b) - WOBBLY_X(o, a) - offsetX);
+    float day = 0.5f * (WOBBLY_Y(o, b) - WOBBLY_Y(o, a) - offsetY);
+
+    float dbx = 0.5f * (WOBBLY_X(o, a) - WOBBLY_X(o, b) + offsetX);
+    float dby = 0.5f * (WOBBLY_Y(o, a) - WOBBLY_Y(o, b) + offsetY);
+
+    fx[a] += k * dax;
+    fy[a] += k * day;
+    fx[b] += k * dbx;
+    fy[b] += k * dby;
+}
+
+static void stepModelScalar(struct wobbly_step_request *request, float friction, float k)
+{
+    struct wobbly_objects *o = request->objects;
+    float fx[WOBBLY_OBJECTS], fy[WOBBLY_OBJECTS];
+    float velocitySum = 0.0f, forceSum = 0.0f;
+    int i, j;
+
+    for (j = 0; j < request->steps; j++)
+    {
+        memset(fx, 0, sizeof(fx));
+        memset(fy, 0, sizeof(fy));
+
+        for (i = 0; i < WOBBLY_OBJECTS; i++)
+        {
+            if (i % WOBBLY_GRID_WIDTH > 0)
+                springExertForces(o, fx, fy, i - 1, i, o->hpad, 0, k);
+
+            if (i / WOBBLY_GRID_WIDTH > 0)
+                springExertForces(o, fx, fy, i - WOBBLY_GRID_WIDTH, i, 0, o->vpad, k);
+        }
+
+        for (i = 0; i < WOBBLY_OBJECTS; i++)
+        {
+            o->theta[i] += 0.05f;
+
+            if (o->mobile[i] == 0.0f)
+            {
+                o->velocity_x[i] = 0.0f;
+                o->velocity_y[i] = 0.0f;
+                continue;
+            }
+
+            fx[i] -= friction * o->velocity_x[i];
+            fy[i] -= friction * o->velocity_y[i];
+
+            o->velocity_x[i] += fx[i] / WOBBLY_MASS;
+            o->velocity_y[i] += fy[i] / WOBBLY_MASS;
+
+            WOBBLY_X(o, i) += o->velocity_x[i];
+            WOBBLY_Y(o, i) += o->velocity_y[i];
+
+            velocitySum += fabs(o->velocity_x[i]) + fabs(o->velocity_y[i]);
+            forceSum += fabs(fx[i]) + fabs(fy[i]);
+        }
+    }
+
+    request->velocity_sum = velocitySum;
+    request->force_sum = forceSum;
+}
+
+void wobbly_step_models_scalar(struct wobbly_step_request *requests, int count,
+    float friction, float k)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        stepModelScalar(&requests[i], friction, k);
+}
+
+#if defined(__GNUC__) && (defined(__SSE2__) || defined(__ARM_NEON)) && \
+    WOBBLY_GRID_WIDTH == 4
+
+/*
+ * Vectorized implementation. A grid row fits exactly in a 128-bit vector,
+ * so every row of objects is processed at once. The horizontal neighbours
+ * are loaded from the padded position arrays shifted by one element, and the
+ * springs which do not exist at the edges of the grid are masked out.
+ *
+ * The forces of each object are accumulated in the same order as in the
+ * scalar implementation (left, top, right, bottom spring).
+ */
+typedef float v4sf __attribute__((vector_size(16)));
+typedef int v4si __attribute__((vector_size(16)));
+typedef double v4df __attribute__((vector_size(32)));
+
+static inline v4sf load4(const float *p)
+{
+    v4sf v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void store4(float *p, v4sf v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+static inline v4sf splat4(float x)
+{
+    return (v4sf) {x, x, x, x};
+}
+
+static inline v4sf abs4(v4sf v)
+{
+    return (v4sf)((v4si)v & (v4si) {0x7fffffff, 0x7fffffff, 0x7fffffff, 0x7fffffff});
+}
+
+/* v + f / WOBBLY_MASS, computed in double precision like the scalar code */
+static inline v4sf accelerate4(v4sf v, v4sf f)
+{
+    v4df result = __builtin_convertvector(v, v4df) +
+        __builtin_convertvector(f, v4df) / WOBBLY_MASS;
+    return __builtin_convertvector(result, v4sf);
+}
+
+static inline float sum4(v4sf v)
+{
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+static void stepModelVector(struct wobbly_step_request *request, float friction, float k)
+{
+    struct wobbly_objects *o = request->objects;
+    const v4sf has_left  = {0.0f, 1.0f, 1.0f, 1.0f};
+    const v4sf has_right = {1.0f, 1.0f, 1.0f, 0.0f};
+    const v4sf half = splat4(0.5f);
+    const v4sf vk = splat4(k);
+    const v4sf vfriction = splat4(friction);
+    const v4sf hpad = splat4(o->hpad);
+    const v4sf vpad = splat4(o->vpad);
+    const v4sf zero = splat4(0.0f);
+    const v4sf dtheta = splat4(0.05f);
+
+    v4sf fx[WOBBLY_GRID_HEIGHT], fy[WOBBLY_GRID_HEIGHT];
+    v4sf velocitySum = zero, forceSum = zero;
+    int j, r;
+
+    for (j = 0; j < request->steps; j++)
+    {
+        for (r = 0; r < WOBBLY_GRID_HEIGHT; r++)
+        {
+            const int row = r * WOBBLY_GRID_WIDTH;
+            v4sf x = load4(&o->position_x[row + 1]);
+            v4sf y = load4(&o->position_y[row + 1]);
+
+            /* spring to the left neighbour, this object is the spring end */
+            v4sf lx = load4(&o->position_x[row]);
+            v4sf ly = load4(&o->position_y[row]);
+            v4sf sx = zero + has_left * (vk * (half * (lx - x + hpad)));
+            v4sf sy = zero + has_left * (vk * (half * (ly - y + zero)));
+
+            /* spring to the neighbour above, this object is the spring end */
+            if (r > 0)
+            {
+                v4sf ux = load4(&o->position_x[row - WOBBLY_GRID_WIDTH + 1]);
+                v4sf uy = load4(&o->position_y[row - WOBBLY_GRID_WIDTH + 1]);
+                sx += vk * (half * (ux - x + zero));
+                sy += vk * (half * (uy - y + vpad));
+            }
+
+            /* spring to the right neighbour, this object is the spring start */
+            v4sf rx = load4(&o->position_x[row + 2]);
+            v4sf ry = load4(&o->position_y[row + 2]);
+            sx += has_right * (vk * (half * (rx - x - hpad)));
+            sy += has_right * (vk * (half * (ry - y - zero)));
+
+            /* spring to the neighbour below, this object is the spring start */
+            if (r < WOBBLY_GRID_HEIGHT - 1)
+            {
+                v4sf dx = load4(&o->position_x[row + WOBBLY_GRID_WIDTH + 1]);
+                v4sf dy = load4(&o->position_y[row + WOBBLY_GRID_WIDTH + 1]);
+                sx += vk * (half * (dx - x - zero));
+                sy += vk * (half * (dy - y - vpad));
+            }
+
+            fx[r] = sx;
+            fy[r] = sy;
+        }
+
+        for (r = 0; r < WOBBLY_GRID_HEIGHT; r++)
+        {
+            const int row = r * WOBBLY_GRID_WIDTH;
+            v4sf mobile = load4(&o->mobile[row]);
+            v4sf vx = load4(&o->velocity_x[row]);
+            v4sf vy = load4(&o->velocity_y[row]);
+
+            store4(&o->theta[row], load4(&o->theta[row]) + dtheta);
+
+            v4sf sx = fx[r] - vfriction * vx;
+            v4sf sy = fy[r] - vfriction * vy;
+
+            /* immobile objects have no velocity and exert no force */
+            vx = mobile * accelerate4(vx, sx);
+            vy = mobile * accelerate4(vy, sy);
+            store4(&o->velocity_x[row], vx);
+            store4(&o->velocity_y[row], vy);
+
+            store4(&o->position_x[row + 1], load4(&o->position_x[row + 1]) + vx);
+            store4(&o->position_y[row + 1], load4(&o->position_y[row + 1]) + vy);
+
+            velocitySum += abs4(vx) + abs4(vy);
+            forceSum += mobile * (abs4(sx) + abs4(sy));
+        }
+    }
+
+    request->velocity_sum = sum4(velocitySum);
+    request->force_sum = sum4(forceSum);
+}
+
+void wobbly_step_models(struct wobbly_step_request *requests, int count,
+    float friction, float k)
+{
+    int i;
+    for (i = 0; i < count; i++)
+        stepModelVector(&requests[i], friction, k);
+}
+
+#else
+
+void wobbly_step_models(struct wobbly_step_request *requests, int count,
+    float friction, float k)
+{
+    wobbly_step_models_scalar(requests, count, friction, k);
+}
+
+#endif
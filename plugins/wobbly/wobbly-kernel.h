@@ -0,0 +1,87 @@
+/*
+ * Copyright © 2005 Novell, Inc.
+ * Copyright © 2014 Scott Moreau
+ *
+ * Permission to use, copy, modify, distribute, and sell this software
+ * and its documentation for any purpose is hereby granted without
+ * fee, provided that the above copyright notice appear in all copies
+ * and that both that copyright notice and this permission notice
+ * appear in supporting documentation, and that the name of
+ * Novell, Inc. not be used in advertising or publicity pertaining to
+ * distribution of the software without specific, written prior permission.
+ * Novell, Inc. makes no representations about the suitability of this
+ * software for any purpose. It is provided "as is" without express or
+ * implied warranty.
+ */
+
+/*
+ * The spring model of wobbly, stored as a structure of arrays so that all
+ * objects of a model (and all models of a frame) can be stepped with a single
+ * vectorized kernel.
+ */
+
+#ifndef WOBBLY_KERNEL_H
+#define WOBBLY_KERNEL_H
+
+#define WOBBLY_GRID_WIDTH  4
+#define WOBBLY_GRID_HEIGHT 4
+#define WOBBLY_OBJECTS (WOBBLY_GRID_WIDTH * WOBBLY_GRID_HEIGHT)
+
+#ifndef WOBBLY_MASS
+#define WOBBLY_MASS 15.0
+#endif
+
+/*
+ * The objects of a single model. Object i is at grid position
+ * (i % WOBBLY_GRID_WIDTH, i / WOBBLY_GRID_WIDTH). Every object is connected
+ * with springs to its horizontal and vertical neighbours, the rest lengths
+ * of the springs are hpad and vpad.
+ *
+ * The position arrays have one element of padding on each side, so that
+ * the neighbours of a row can be loaded with unaligned vector loads.
+ */
+struct wobbly_objects
+{
+    float position_x[WOBBLY_OBJECTS + 2];
+    float position_y[WOBBLY_OBJECTS + 2];
+    float velocity_x[WOBBLY_OBJECTS];
+    float velocity_y[WOBBLY_OBJECTS];
+    float theta[WOBBLY_OBJECTS];
+    /* 0.0f for immobile objects, 1.0f for the others */
+    float mobile[WOBBLY_OBJECTS];
+
+    float hpad, vpad;
+};
+
+/* Accessors which hide the padding of the position arrays */
+#define WOBBLY_X(objects, i) ((objects)->position_x[(i) + 1])
+#define WOBBLY_Y(objects, i) ((objects)->position_y[(i) + 1])
+
+/*
+ * A request to step a single model in wobbly_step_models().
+ */
+struct wobbly_step_request
+{
+    struct wobbly_objects *objects;
+    int steps;
+
+    /* Filled in by wobbly_step_models(): the sum of the velocities and forces
+     * of all objects over all steps. */
+    float velocity_sum;
+    float force_sum;
+};
+
+/*
+ * Step all given models @steps times with the given friction and spring
+ * constant. Uses SIMD instructions where the compiler supports them.
+ */
+void wobbly_step_models(struct wobbly_step_request *requests, int count,
+    float friction, float k);
+
+/*
+ * Same as wobbly_step_models(), but always uses the scalar implementation.
+ */
+void wobbly_step_models_scalar(struct wobbly_step_request *requests, int count,
+    float friction, float k);
+
+#endif /* WOBBLY_KERNEL_H */
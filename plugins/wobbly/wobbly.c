@@ -36,48 +36,22 @@
 #include <stdio.h>
 
 #include "wobbly.h"
+#include "wobbly-kernel.h"
 
-#define GRID_WIDTH  4
-#define GRID_HEIGHT 4
+#define GRID_WIDTH  WOBBLY_GRID_WIDTH
+#define GRID_HEIGHT WOBBLY_GRID_HEIGHT
 
-#define MODEL_MAX_SPRINGS (GRID_WIDTH * GRID_HEIGHT * 2)
+/* Objects are referred to by their index in the model */
+#define NO_OBJECT (-1)
 
 typedef struct _xy_pair {
     float x, y;
-} Point, Vector;
-
-typedef struct _Edge {
-    float next, prev;
-
-    float start;
-    float end;
-
-    float attract;
-    float velocity;
-} Edge;
-
-typedef struct _Object {
-    Vector	 force;
-    Point	 position;
-    Vector	 velocity;
-    float	 theta;
-    int		 immobile;
-    Edge	 vertEdge;
-    Edge	 horzEdge;
-} Object;
-
-typedef struct _Spring {
-    Object *a;
-    Object *b;
-    Vector offset;
-} Spring;
+} Point;
 
 typedef struct _Model {
-    Object	 *objects;
+    struct wobbly_objects objects;
     int		 numObjects;
-    Spring	 springs[MODEL_MAX_SPRINGS];
-    int		 numSprings;
-    Object	 *anchorObject;
+    int		 anchorObject;
     float	 steps;
     Point	 topLeft;
     Point	 bottomRight;
@@ -97,32 +71,30 @@ typedef struct _WobblyWindow {
 #define WobblyForce    (1L << 1)
 #define WobblyVelocity (1L << 2)
 
-static void objectInit(Object *object, float positionX, float positionY,
-        float velocityX, float velocityY)
-{
-    object->force.x = 0;
-    object->force.y = 0;
-
-    object->position.x = positionX;
-    object->position.y = positionY;
-
-    object->velocity.x = velocityX;
-    object->velocity.y = velocityY;
+#define OBJ_X(model, i) WOBBLY_X(&(model)->objects, i)
+#define OBJ_Y(model, i) WOBBLY_Y(&(model)->objects, i)
 
-    object->theta    = 0;
-    object->immobile = 0;
+static void objectSetImmobile(Model *model, int object, int immobile)
+{
+    model->objects.mobile[object] = immobile ? 0.0f : 1.0f;
+}
 
-    object->vertEdge.next = 0.0f;
-    object->horzEdge.next = 0.0f;
+static int objectIsImmobile(Model *model, int object)
+{
+    return model->objects.mobile[object] == 0.0f;
 }
 
-static void springInit(Spring *spring, Object *a, Object *b,
-	    float offsetX, float offsetY)
+static void objectInit(Model *model, int object, float positionX, float positionY,
+        float velocityX, float velocityY)
 {
-    spring->a	     = a;
-    spring->b	     = b;
-    spring->offset.x = offsetX;
-    spring->offset.y = offsetY;
+    OBJ_X(model, object) = positionX;
+    OBJ_Y(model, object) = positionY;
+
+    model->objects.velocity_x[object] = velocityX;
+    model->objects.velocity_y[object] = velocityY;
+
+    model->objects.theta[object] = 0;
+    objectSetImmobile(model, object, 0);
 }
 
 static void modelCalcBounds(Model *model)
@@ -136,29 +108,18 @@ static void modelCalcBounds(Model *model)
 
     for (i = 0; i < model->numObjects; i++)
     {
-        if (model->objects[i].position.x < model->topLeft.x)
-            model->topLeft.x = model->objects[i].position.x;
-        else if (model->objects[i].position.x > model->bottomRight.x)
-            model->bottomRight.x = model->objects[i].position.x;
-
-        if (model->objects[i].position.y < model->topLeft.y)
-            model->topLeft.y = model->objects[i].position.y;
-        else if (model->objects[i].position.y > model->bottomRight.y)
-            model->bottomRight.y = model->objects[i].position.y;
+        if (OBJ_X(model, i) < model->topLeft.x)
+            model->topLeft.x = OBJ_X(model, i);
+        else if (OBJ_X(model, i) > model->bottomRight.x)
+            model->bottomRight.x = OBJ_X(model, i);
+
+        if (OBJ_Y(model, i) < model->topLeft.y)
+            model->topLeft.y = OBJ_Y(model, i);
+        else if (OBJ_Y(model, i) > model->bottomRight.y)
+            model->bottomRight.y = OBJ_Y(model, i);
     }
 }
 
-static void modelAddSpring(Model *model, Object *a, Object *b,
-		float offsetX, float offsetY)
-{
-    Spring *spring;
-
-    spring = &model->springs[model->numSprings];
-    model->numSprings++;
-
-    springInit (spring, a, b, offsetX, offsetY);
-}
-
 static void modelSetMiddleAnchor(Model *model, int x, int y,
         int width, int height)
 {
@@ -167,15 +128,14 @@ static void modelSetMiddleAnchor(Model *model, int x, int y,
     gx = ((GRID_WIDTH  - 1) / 2 * width)  / (float) (GRID_WIDTH  - 1);
     gy = ((GRID_HEIGHT - 1) / 2 * height) / (float) (GRID_HEIGHT - 1);
 
-    if (model->anchorObject)
-        model->anchorObject->immobile = 0;
+    if (model->anchorObject != NO_OBJECT)
+        objectSetImmobile(model, model->anchorObject, 0);
 
-    model->anchorObject =
-        &model->objects[GRID_WIDTH * ((GRID_HEIGHT-1)/2) + (GRID_WIDTH-1)/ 2];
-    model->anchorObject->position.x = x + gx;
-    model->anchorObject->position.y = y + gy;
+    model->anchorObject = GRID_WIDTH * ((GRID_HEIGHT-1)/2) + (GRID_WIDTH-1)/ 2;
+    OBJ_X(model, model->anchorObject) = x + gx;
+    OBJ_Y(model, model->anchorObject) = y + gy;
 
-    model->anchorObject->immobile = 1;
+    objectSetImmobile(model, model->anchorObject, 1);
 }
 
 static void modelSetTopAnchor(Model *model, int x, int y,
@@ -185,14 +145,14 @@ static void modelSetTopAnchor(Model *model, int x, int y,
 
     gx = ((GRID_WIDTH  - 1) / 2 * width)  / (float) (GRID_WIDTH  - 1);
 
-    if (model->anchorObject)
-	model->anchorObject->immobile = 0;
+    if (model->anchorObject != NO_OBJECT)
+	objectSetImmobile(model, model->anchorObject, 0);
 
-    model->anchorObject = &model->objects[(GRID_WIDTH-1)/ 2];
-    model->anchorObject->position.x = x + gx;
-    model->anchorObject->position.y = y;
+    model->anchorObject = (GRID_WIDTH-1)/ 2;
+    OBJ_X(model, model->anchorObject) = x + gx;
+    OBJ_Y(model, model->anchorObject) = y;
 
-    model->anchorObject->immobile = 1;
+    objectSetImmobile(model, model->anchorObject, 1);
 }
 
 static void modelInitObjects(Model *model, int x, int y, int width, int height)
@@ -207,7 +167,7 @@ static void modelInitObjects(Model *model, int x, int y, int width, int height)
     {
         for (gridX = 0; gridX < GRID_WIDTH; gridX++)
         {
-            objectInit (&model->objects[i],
+            objectInit (model, i,
                     x + (gridX * width) / gw,
                     y + (gridY * height) / gh,
                     0, 0);
@@ -215,59 +175,28 @@ static void modelInitObjects(Model *model, int x, int y, int width, int height)
         }
     }
 
-    if (!model->anchorObject)
+    if (model->anchorObject == NO_OBJECT)
         modelSetMiddleAnchor (model, x, y, width, height);
 }
 
+/* Every object is connected with springs to its horizontal and vertical
+ * neighbours, so only the rest lengths need to be stored. */
 static void modelInitSprings(Model *model, int width, int height)
 {
-    int   gridX, gridY, i = 0;
-    float hpad, vpad;
-
-    model->numSprings = 0;
-
-    hpad = ((float) width) / (GRID_WIDTH  - 1);
-    vpad = ((float) height) / (GRID_HEIGHT - 1);
-
-    for (gridY = 0; gridY < GRID_HEIGHT; gridY++)
-    {
-        for (gridX = 0; gridX < GRID_WIDTH; gridX++)
-        {
-            if (gridX > 0)
-            {
-                modelAddSpring (model, &model->objects[i - 1],
-                        &model->objects[i], hpad, 0);
-            }
-
-            if (gridY > 0)
-            {
-                modelAddSpring (model, &model->objects[i - GRID_WIDTH],
-                        &model->objects[i], 0, vpad);
-            }
-
-            i++;
-        }
-    }
+    model->objects.hpad = ((float) width) / (GRID_WIDTH  - 1);
+    model->objects.vpad = ((float) height) / (GRID_HEIGHT - 1);
 }
 
 static Model * createModel(int x, int y, int width, int height)
 {
     Model *model;
 
-    model = malloc(sizeof(Model));
+    model = calloc(1, sizeof(Model));
     if (!model)
         return 0;
 
-    model->numObjects = GRID_WIDTH * GRID_HEIGHT;
-    model->objects = malloc (sizeof (Object) * model->numObjects);
-    if (!model->objects)
-    {
-        free (model);
-        return 0;
-    }
-
-    model->anchorObject = 0;
-    model->numSprings = 0;
+    model->numObjects = WOBBLY_OBJECTS;
+    model->anchorObject = NO_OBJECT;
     model->steps = 0;
 
     modelInitObjects (model, x, y, width, height);
@@ -277,94 +206,52 @@ static Model * createModel(int x, int y, int width, int height)
     return model;
 }
 
-static void objectApplyForce(Object *object, float fx, float fy)
-{
-    object->force.x += fx;
-    object->force.y += fy;
-}
-
-static void springExertForces(Spring *spring, float k)
-{
-    Vector da, db;
-    Vector a, b;
-
-    a = spring->a->position;
-    b = spring->b->position;
-
-    da.x = 0.5f * (b.x - a.x - spring->offset.x);
-    da.y = 0.5f * (b.y - a.y - spring->offset.y);
-
-    db.x = 0.5f * (a.x - b.x + spring->offset.x);
-    db.y = 0.5f * (a.y - b.y + spring->offset.y);
-
-    objectApplyForce (spring->a, k * da.x, k * da.y);
-    objectApplyForce (spring->b, k * db.x, k * db.y);
-}
-
-static float modelStepObject(Object *object, float friction, float *force)
+/*
+ * Apply an impulse to the objects connected with springs to @object,
+ * pushing them away from it.
+ */
+static void modelPushNeighbours(Model *model, int object)
 {
-    object->theta += 0.05f;
-
-    if (object->immobile)
-    {
-        object->velocity.x = 0.0f;
-        object->velocity.y = 0.0f;
-        object->force.x = 0.0f;
-        object->force.y = 0.0f;
-
-        *force = 0.0f;
-        return 0.0f;
-    }
-    else
-    {
-        object->force.x -= friction * object->velocity.x;
-        object->force.y -= friction * object->velocity.y;
+    int gridX = object % GRID_WIDTH;
+    int gridY = object / GRID_WIDTH;
+    float hpad = model->objects.hpad;
+    float vpad = model->objects.vpad;
 
-        object->velocity.x += object->force.x / WOBBLY_MASS;
-        object->velocity.y += object->force.y / WOBBLY_MASS;
+    if (gridX > 0)
+        model->objects.velocity_x[object - 1] += hpad * 0.05f;
 
-        object->position.x += object->velocity.x;
-        object->position.y += object->velocity.y;
+    if (gridX < GRID_WIDTH - 1)
+        model->objects.velocity_x[object + 1] -= hpad * 0.05f;
 
-        *force = fabs(object->force.x) + fabs(object->force.y);
+    if (gridY > 0)
+        model->objects.velocity_y[object - GRID_WIDTH] += vpad * 0.05f;
 
-        object->force.x = 0.0f;
-        object->force.y = 0.0f;
-
-        return fabs(object->velocity.x) + fabs(object->velocity.y);
-    }
+    if (gridY < GRID_HEIGHT - 1)
+        model->objects.velocity_y[object + GRID_WIDTH] -= vpad * 0.05f;
 }
 
-static int modelStep(Model *model, float friction, float k, float time)
+/* Advance the step counter of the model and return the number of steps to do now */
+static int modelTakeSteps(Model *model, float time)
 {
-    int   i, j, steps, wobbly = 0;
-    float velocitySum = 0.0f;
-    float force, forceSum = 0.0f;
+    int steps;
 
     model->steps += time / 15.0f;
     steps = floor (model->steps);
     model->steps -= steps;
 
-    if (!steps)
-        return 1;
-
-    for (j = 0; j < steps; j++)
-    {
-        for (i = 0; i < model->numSprings; i++)
-            springExertForces (&model->springs[i], k);
+    return steps;
+}
 
-        for (i = 0; i < model->numObjects; i++)
-        {
-            velocitySum += modelStepObject(&model->objects[i], friction, &force);
-            forceSum += force;
-        }
-    }
+static int modelStepResult(struct wobbly_step_request *request)
+{
+    int wobbly = 0;
 
-    modelCalcBounds (model);
+    if (!request->steps)
+        return 1;
 
-    if (velocitySum > 0.5f)
+    if (request->velocity_sum > 0.5f)
         wobbly |= WobblyVelocity;
-    if (forceSum > 20.0f)
+    if (request->force_sum > 20.0f)
         wobbly |= WobblyForce;
 
     return wobbly;
@@ -394,9 +281,9 @@ static void bezierPatchEvaluate (Model *model, float u, float v,
         for (j = 0; j < 4; j++)
         {
             x += coeffsU[i] * coeffsV[j] *
-                model->objects[j * GRID_WIDTH + i].position.x;
+                OBJ_X(model, j * GRID_WIDTH + i);
             y += coeffsU[i] * coeffsV[j] *
-                model->objects[j * GRID_HEIGHT + i].position.y;
+                OBJ_Y(model, j * GRID_HEIGHT + i);
         }
     }
 
@@ -419,123 +306,145 @@ static int wobblyEnsureModel(struct wobbly_surface *surface)
     return 1;
 }
 
-static float objectDistance(Object *object, float x, float y)
+static float objectDistance(Model *model, int object, float x, float y)
 {
     float dx, dy;
-    dx = object->position.x - x;
-    dy = object->position.y - y;
+    dx = OBJ_X(model, object) - x;
+    dy = OBJ_Y(model, object) - y;
 
     return sqrt(dx * dx + dy * dy);
 }
 
-static Object *modelFindNearestObject(Model *model, float x, float y)
+static int modelFindNearestObject(Model *model, float x, float y)
 {
-    Object *object = &model->objects[0];
+    int    object = 0;
     float  distance, minDistance = 0.0;
     int    i;
 
     for (i = 0; i < model->numObjects; i++)
     {
-        distance = objectDistance(&model->objects[i], x, y);
+        distance = objectDistance(model, i, x, y);
         if (i == 0 || distance < minDistance)
         {
             minDistance = distance;
-            object = &model->objects[i];
+            object = i;
         }
     }
 
     return object;
 }
 
+static void modelAdjustCorner(Model *model, int object, int x, int y,
+        int make_immobile)
+{
+    OBJ_X(model, object) = x;
+    OBJ_Y(model, object) = y;
+    objectSetImmobile(model, object, make_immobile);
+}
+
 static void modelAdjustCorners(Model *model, int x, int y,
         int width, int height, int make_immobile)
 {
-    Object *o;
-    o = &model->objects[0];
-    o->position.x = x;
-    o->position.y = y;
-    o->immobile = make_immobile;
-
-    o = &model->objects[GRID_WIDTH - 1];
-    o->position.x = x + width;
-    o->position.y = y;
-    o->immobile = make_immobile;
-
-    o = &model->objects[GRID_WIDTH * (GRID_HEIGHT - 1)];
-    o->position.x = x;
-    o->position.y = y + height;
-    o->immobile = make_immobile;
+    modelAdjustCorner(model, 0, x, y, make_immobile);
+    modelAdjustCorner(model, GRID_WIDTH - 1, x + width, y, make_immobile);
+    modelAdjustCorner(model, GRID_WIDTH * (GRID_HEIGHT - 1), x, y + height, make_immobile);
+    modelAdjustCorner(model, model->numObjects - 1, x + width, y + height, make_immobile);
 
-    o = &model->objects[model->numObjects - 1];
-    o->position.x = x + width;
-    o->position.y = y + height;
-    o->immobile = make_immobile;
-
-    if (!model->anchorObject)
-        model->anchorObject = &model->objects[0];
+    if (model->anchorObject == NO_OBJECT)
+        model->anchorObject = 0;
 }
 
-static int modelRemoveEdgeAnchors(Model *model)
+static int modelRemoveEdgeAnchor(Model *model, int object)
 {
     int result = 0;
-    Object *o;
-
-    o = &model->objects[0];
-    if (o != model->anchorObject)
+    if (object != model->anchorObject)
     {
-        result |= o->immobile;
-        o->immobile = 0;
+        result = objectIsImmobile(model, object);
+        objectSetImmobile(model, object, 0);
     }
 
-    o = &model->objects[GRID_WIDTH - 1];
-    if (o != model->anchorObject)
-    {
-        result |= o->immobile;
-        o->immobile = 0;
-    }
+    return result;
+}
 
-    o = &model->objects[GRID_WIDTH * (GRID_HEIGHT - 1)];
-    if (o != model->anchorObject)
-    {
-        result |= o->immobile;
-        o->immobile = 0;
-    }
+static int modelRemoveEdgeAnchors(Model *model)
+{
+    int result = 0;
 
-    o = &model->objects[model->numObjects - 1];
-    if (o != model->anchorObject)
-    {
-        result |= o->immobile;
-        o->immobile = 0;
-    }
+    result |= modelRemoveEdgeAnchor(model, 0);
+    result |= modelRemoveEdgeAnchor(model, GRID_WIDTH - 1);
+    result |= modelRemoveEdgeAnchor(model, GRID_WIDTH * (GRID_HEIGHT - 1));
+    result |= modelRemoveEdgeAnchor(model, model->numObjects - 1);
 
     return result;
 }
 
 void wobbly_prepare_paint(struct wobbly_surface *surface, int msSinceLastPaint)
 {
-    WobblyWindow *ww = surface->ww;
+    wobbly_prepare_paint_batch(&surface, &msSinceLastPaint, 1);
+}
+
+void wobbly_prepare_paint_batch(struct wobbly_surface **surfaces,
+    const int *msSinceLastPaint, int count)
+{
+    struct wobbly_step_request  local_requests[8];
+    struct wobbly_step_request *requests = local_requests;
+    struct wobbly_surface *local_stepped[8];
+    struct wobbly_surface **stepped = local_stepped;
     float  friction, springK;
+    int    i, n = 0;
 
     friction = wobbly_settings_get_friction();
     springK  = wobbly_settings_get_spring_k();
 
-    if (ww->wobbly)
+    if (count > 8)
+    {
+        requests = malloc(sizeof(*requests) * count);
+        stepped  = malloc(sizeof(*stepped) * count);
+        if (!requests || !stepped)
+        {
+            free(requests);
+            free(stepped);
+            return;
+        }
+    }
+
+    for (i = 0; i < count; i++)
     {
+        WobblyWindow *ww = surfaces[i]->ww;
         if (ww->wobbly & (WobblyInitial | WobblyVelocity | WobblyForce))
         {
-            ww->wobbly = modelStep(ww->model, friction, springK,
-                    (ww->wobbly & WobblyVelocity) ?
-                    msSinceLastPaint : 16);
-
-            if (ww->wobbly) {
-                modelCalcBounds(ww->model);
-            } else {
-                surface->x = ww->model->topLeft.x;
-                surface->y = ww->model->topLeft.y;
-                surface->synced = 1;
-            }
+            requests[n].objects = &ww->model->objects;
+            requests[n].steps = modelTakeSteps(ww->model,
+                (ww->wobbly & WobblyVelocity) ? msSinceLastPaint[i] : 16);
+            stepped[n] = surfaces[i];
+            n++;
         }
     }
+
+    /* Step all models at once */
+    wobbly_step_models(requests, n, friction, springK);
+
+    for (i = 0; i < n; i++)
+    {
+        struct wobbly_surface *surface = stepped[i];
+        WobblyWindow *ww = surface->ww;
+
+        ww->wobbly = modelStepResult(&requests[i]);
+        modelCalcBounds(ww->model);
+
+        if (!ww->wobbly)
+        {
+            surface->x = ww->model->topLeft.x;
+            surface->y = ww->model->topLeft.y;
+            surface->synced = 1;
+        }
+    }
+
+    if (requests != local_requests)
+    {
+        free(requests);
+        free(stepped);
+    }
 }
 
 void wobbly_done_paint(struct wobbly_surface *surface)
@@ -617,8 +526,8 @@ void wobbly_move_notify(struct wobbly_surface *surface, int x, int y)
     WobblyWindow *ww = surface->ww;
     if (ww->grabbed)
     {
-        ww->model->anchorObject->position.x = x + ww->grab_dx;
-        ww->model->anchorObject->position.y = y + ww->grab_dy;
+        OBJ_X(ww->model, ww->model->anchorObject) = x + ww->grab_dx;
+        OBJ_Y(ww->model, ww->model->anchorObject) = y + ww->grab_dy;
 
         ww->wobbly |= WobblyInitial;
         surface->synced = 0;
@@ -630,29 +539,10 @@ void wobbly_slight_wobble(struct wobbly_surface *surface)
     WobblyWindow *ww = surface->ww;
     if (wobblyEnsureModel(surface))
     {
-        Object *centerObj;
-        Spring *s;
-        int	   i;
-
-        centerObj = modelFindNearestObject(ww->model,
+        int centerObj = modelFindNearestObject(ww->model,
             surface->x + surface->width / 2, surface->y + surface->height / 2);
 
-        for (i = 0; i < ww->model->numSprings; i++)
-        {
-            s = &ww->model->springs[i];
-
-            if (s->a == centerObj)
-            {
-                s->b->velocity.x -= s->offset.x * 0.05f;
-                s->b->velocity.y -= s->offset.y * 0.05f;
-            }
-            else if (s->b == centerObj)
-            {
-                s->a->velocity.x += s->offset.x * 0.05f;
-                s->a->velocity.y += s->offset.y * 0.05f;
-            }
-        }
-
+        modelPushNeighbours(ww->model, centerObj);
         ww->wobbly |= WobblyInitial;
     }
 }
@@ -673,33 +563,18 @@ void wobbly_grab_notify(struct wobbly_surface *surface, int x, int y)
 
     if (wobblyEnsureModel(surface))
     {
-        Spring *s;
-        int	   i;
+        Model *model = ww->model;
 
-        if (ww->model->anchorObject)
-            ww->model->anchorObject->immobile = 0;
+        if (model->anchorObject != NO_OBJECT)
+            objectSetImmobile(model, model->anchorObject, 0);
 
-        ww->model->anchorObject = modelFindNearestObject(ww->model, x, y);
-        ww->model->anchorObject->immobile = 1;
-        ww->grab_dx = ww->model->anchorObject->position.x - x;
-        ww->grab_dy = ww->model->anchorObject->position.y - y;
+        model->anchorObject = modelFindNearestObject(model, x, y);
+        objectSetImmobile(model, model->anchorObject, 1);
+        ww->grab_dx = OBJ_X(model, model->anchorObject) - x;
+        ww->grab_dy = OBJ_Y(model, model->anchorObject) - y;
 
         ww->grabbed = 1;
-        for (i = 0; i < ww->model->numSprings; i++)
-        {
-            s = &ww->model->springs[i];
-
-            if (s->a == ww->model->anchorObject)
-            {
-                s->b->velocity.x -= s->offset.x * 0.05f;
-                s->b->velocity.y -= s->offset.y * 0.05f;
-            }
-            else if (s->b == ww->model->anchorObject)
-            {
-                s->a->velocity.x += s->offset.x * 0.05f;
-                s->a->velocity.y += s->offset.y * 0.05f;
-            }
-        }
+        modelPushNeighbours(model, model->anchorObject);
 
         ww->wobbly |= WobblyInitial;
     }
@@ -712,10 +587,10 @@ void wobbly_ungrab_notify(struct wobbly_surface *surface)
     {
         if (ww->model)
         {
-            if (ww->model->anchorObject)
-                ww->model->anchorObject->immobile = 0;
+            if (ww->model->anchorObject != NO_OBJECT)
+                objectSetImmobile(ww->model, ww->model->anchorObject, 0);
 
-            ww->model->anchorObject = NULL;
+            ww->model->anchorObject = NO_OBJECT;
 
             ww->wobbly |= WobblyInitial;
         }
@@ -753,7 +628,6 @@ void wobbly_fini(struct wobbly_surface *surface)
 
     if (ww->model)
     {
-        free(ww->model->objects);
         free(ww->model);
         free(surface->v);
     }
@@ -768,10 +642,10 @@ void wobbly_force_geometry(struct wobbly_surface *surface,
 
     if (wobblyEnsureModel(surface))
     {
-		if (!ww->grabbed && ww->model->anchorObject)
+		if (!ww->grabbed && ww->model->anchorObject != NO_OBJECT)
 		{
-		    ww->model->anchorObject->immobile = 0;
-		    ww->model->anchorObject = NULL;
+		    objectSetImmobile(ww->model, ww->model->anchorObject, 0);
+		    ww->model->anchorObject = NO_OBJECT;
 		}
 
         surface->x = x;
@@ -795,7 +669,8 @@ void wobbly_unenforce_geometry(struct wobbly_surface *surface)
     {
         if (modelRemoveEdgeAnchors(ww->model))
         {
-            if (!ww->model->anchorObject || !ww->model->anchorObject->immobile)
+            if (ww->model->anchorObject == NO_OBJECT ||
+                !objectIsImmobile(ww->model, ww->model->anchorObject))
             {
                 modelSetMiddleAnchor(ww->model, surface->x, surface->y,
                     surface->width, surface->height);
@@ -814,8 +689,8 @@ void wobbly_translate(struct wobbly_surface *surface, int dx, int dy)
     {
         for (int i = 0; i < ww->model->numObjects; i++)
         {
-            ww->model->objects[i].position.x += dx;
-            ww->model->objects[i].position.y += dy;
+            OBJ_X(ww->model, i) += dx;
+            OBJ_Y(ww->model, i) += dy;
         }
 
         ww->model->topLeft.x += dx;
@@ -837,8 +712,8 @@ void wobbly_scale(struct wobbly_surface *surface, double dx, double dy)
     {
         for (int i = 0; i < ww->model->numObjects; i++)
         {
-            scale(surface->x, &ww->model->objects[i].position.x, dx);
-            scale(surface->y, &ww->model->objects[i].position.y, dy);
+            scale(surface->x, &OBJ_X(ww->model, i), dx);
+            scale(surface->y, &OBJ_Y(ww->model, i), dy);
         }
 
         scale(surface->x, &ww->model->topLeft.x, dx);
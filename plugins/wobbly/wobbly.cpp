@@ -2,7 +2,9 @@
 #include "wayfire/opengl.hpp"
 #include "wayfire/region.hpp"
 #include <memory>
+#include <algorithm>
 #include <wayfire/plugin.hpp>
+#include <wayfire/output-layout.hpp>
 #include <wayfire/signal-definitions.hpp>
 #include <wayfire/core.hpp>
 #include <wayfire/view-transform.hpp>
@@ -677,7 +679,39 @@ class wobbly_transformer_node_t : public wf::scene::transformer_base_node_t
     }
 
   public:
-    void update_model()
+    /**
+     * Update the wobbly models of the given nodes. The models of all nodes are
+     * stepped together, which is considerably faster than stepping them one by
+     * one.
+     */
+    static void update_models(const std::vector<std::shared_ptr<wobbly_transformer_node_t>>& nodes)
+    {
+        auto now = wf::get_current_time();
+
+        std::vector<wobbly_surface*> surfaces;
+        std::vector<int> elapsed;
+        for (auto& node : nodes)
+        {
+            if (node->begin_model_update(now))
+            {
+                surfaces.push_back(node->model.get());
+                elapsed.push_back(now - node->last_frame);
+                node->last_frame = now;
+            }
+        }
+
+        wobbly_prepare_paint_batch(surfaces.data(), elapsed.data(), (int)surfaces.size());
+        for (auto& node : nodes)
+        {
+            node->end_model_update();
+        }
+    }
+
+  private:
+    bool model_update_pending = false;
+
+    /** @return Whether the model needs to be stepped. */
+    bool begin_model_update(int64_t now)
     {
         view->damage();
 
@@ -687,18 +721,24 @@ class wobbly_transformer_node_t : public wf::scene::transformer_base_node_t
         state->handle_frame();
         view->connect(&on_view_geometry_changed);
 
-        /* Update all the wobbly model */
-        auto now = wf::get_current_time();
-
-        if (now > last_frame)
+        model_update_pending = (now > last_frame);
+        if (model_update_pending)
         {
             view->get_transformed_node()->begin_transform_update();
-            wobbly_prepare_paint(model.get(), now - last_frame);
+        }
+
+        return model_update_pending;
+    }
+
+    void end_model_update()
+    {
+        if (model_update_pending)
+        {
             /* Update wobbly geometry */
-            last_frame = now;
             wobbly_add_geometry(model.get());
             wobbly_done_paint(model.get());
             view->get_transformed_node()->end_transform_update();
+            model_update_pending = false;
         }
 
         if (state->is_wobbly_done())
@@ -707,6 +747,7 @@ class wobbly_transformer_node_t : public wf::scene::transformer_base_node_t
         }
     }
 
+  public:
     /**
      * Update the current wobbly state based on:
      * 1. View state (tiled & fullscreen)
@@ -853,11 +894,69 @@ class wobbly_transformer_node_t : public wf::scene::transformer_base_node_t
     }
 };
 
+/**
+ * Steps the models of all wobbly views visible on an output together, before
+ * the output is repainted.
+ */
+class wobbly_output_updater_t : public wf::custom_data_t
+{
+    wf::output_t *output = nullptr;
+    std::vector<wobbly_transformer_node_t*> nodes;
+
+    wf::effect_hook_t pre_hook = [=] ()
+    {
+        // Updating may destroy nodes, keep them alive until we are done.
+        std::vector<std::shared_ptr<wobbly_transformer_node_t>> alive;
+        for (auto& node : nodes)
+        {
+            auto ptr = std::dynamic_pointer_cast<wobbly_transformer_node_t>(node->shared_from_this());
+            if (std::find(alive.begin(), alive.end(), ptr) == alive.end())
+            {
+                alive.push_back(ptr);
+            }
+        }
+
+        wobbly_transformer_node_t::update_models(alive);
+    };
+
+  public:
+    ~wobbly_output_updater_t()
+    {
+        if (!nodes.empty())
+        {
+            output->render->rem_effect(&pre_hook);
+        }
+    }
+
+    void add_node(wf::output_t *output, wobbly_transformer_node_t *node)
+    {
+        this->output = output;
+        if (nodes.empty())
+        {
+            output->render->add_effect(&pre_hook, wf::OUTPUT_EFFECT_PRE);
+        }
+
+        nodes.push_back(node);
+    }
+
+    void remove_node(wobbly_transformer_node_t *node)
+    {
+        auto it = std::find(nodes.begin(), nodes.end(), node);
+        if (it != nodes.end())
+        {
+            nodes.erase(it);
+            if (nodes.empty())
+            {
+                output->render->rem_effect(&pre_hook);
+            }
+        }
+    }
+};
+
 class wobbly_render_instance_t :
     public wf::scene::transformer_render_instance_t<wobbly_transformer_node_t>
 {
     wf::output_t *wo = nullptr;
-    wf::effect_hook_t pre_hook;
 
   public:
     wobbly_render_instance_t(wobbly_transformer_node_t *self, wf::scene::damage_callback push_damage,
@@ -866,8 +965,7 @@ class wobbly_render_instance_t :
         if (shown_on)
         {
             wo = shown_on;
-            pre_hook = [=] () { self->update_model(); };
-            wo->render->add_effect(&pre_hook, wf::OUTPUT_EFFECT_PRE);
+            wo->get_data_safe<wobbly_output_updater_t>()->add_node(wo, self);
         }
     }
 
@@ -875,7 +973,10 @@ class wobbly_render_instance_t :
     {
         if (wo)
         {
-            wo->render->rem_effect(&pre_hook);
+            if (auto updater = wo->get_data<wobbly_output_updater_t>())
+            {
+                updater->remove_node(self.get());
+            }
         }
     }
 
@@ -1005,7 +1106,7 @@ class wayfire_wobbly : public wf::plugin_interface_t
 
     void fini() override
     {
-        for (auto& view : wf::get_core().get_all_views())
+        for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
         {
             auto wobbly = view->get_transformed_node()->get_transformer<wobbly_transformer_node_t>("wobbly");
             if (wobbly)
@@ -1014,6 +1115,11 @@ class wayfire_wobbly : public wf::plugin_interface_t
             }
         }
 
+        for (auto& output : wf::get_core().output_layout->get_outputs())
+        {
+            output->erase_data<wobbly_output_updater_t>();
+        }
+
         wf::gles::run_in_context_if_gles([&]
         {
             program.free_resources();
@@ -2,7 +2,9 @@
 #include <memory>
 #include <functional>
 #include <algorithm>
+#include <unordered_map>
 #include <wayfire/dassert.hpp>
+#include <wayfire/object.hpp>
 #include <wayfire/nonstd/observer_ptr.h>
 #include <wayfire/signal-provider.hpp>
 
@@ -45,16 +47,43 @@ class tracking_allocator_t
             std::bind(&tracking_allocator_t<ObjectType>::deallocate_object, this, std::placeholders::_1));
 
         allocated_objects.push_back(ptr.get());
+        if constexpr (std::is_base_of_v<wf::object_base_t, ObjectType>)
+        {
+            ObjectType *obj = ptr.get();
+            objects_by_id[obj->get_id()] = obj;
+        }
+
         return ptr;
     }
 
+    /**
+     * Get a list of all currently allocated objects, in order of allocation.
+     *
+     * The list is not copied, so it may be iterated cheaply. However, callers must not allocate or destroy
+     * objects of the same type while iterating over it. If this is possible, make a copy first.
+     */
     const std::vector<nonstd::observer_ptr<ObjectType>>& get_all()
     {
         return allocated_objects;
     }
 
+    /**
+     * Find an allocated object by its id (see object_base_t::get_id()) in constant time.
+     *
+     * @return The object with the given id, or nullptr if no such object exists.
+     */
+    nonstd::observer_ptr<ObjectType> find_by_id(uint32_t id)
+    {
+        static_assert(std::is_base_of_v<wf::object_base_t, ObjectType>,
+            "find_by_id() requires objects derived from object_base_t");
+        auto it = objects_by_id.find(id);
+        return (it == objects_by_id.end()) ? nullptr : it->second;
+    }
+
   private:
     std::vector<nonstd::observer_ptr<ObjectType>> allocated_objects;
+    std::unordered_map<uint32_t, ObjectType*> objects_by_id;
+
     void deallocate_object(ObjectType *obj)
     {
         if constexpr (std::is_base_of_v<wf::signal::provider_t, ObjectType>)
@@ -68,6 +97,11 @@ class tracking_allocator_t
             nonstd::observer_ptr<ObjectType>{obj});
         wf::dassert(it != allocated_objects.end(), "Object is not allocated?");
         allocated_objects.erase(it);
+        if constexpr (std::is_base_of_v<wf::object_base_t, ObjectType>)
+        {
+            objects_by_id.erase(obj->get_id());
+        }
+
         delete obj;
     }
 };
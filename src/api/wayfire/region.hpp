@@ -69,6 +69,19 @@ struct region_t
      * won't let us pass a const pixman_region32_t* */
     pixman_region32_t *unconst() const;
 };
+
+/**
+ * Approximate a fragmented region with fewer boxes, trading some overdraw for
+ * fewer scissored draw calls. The result always contains the given region.
+ *
+ * If the extents of the region are at most @max_overdraw times larger than the
+ * region itself (for example 0.25 for 25% more area), the region is replaced
+ * by its extents. Otherwise, if the region has more than @max_boxes boxes, it
+ * is split into horizontal strips, and in each strip nearby boxes are merged
+ * until the whole region has at most @max_boxes boxes. A non-positive
+ * @max_boxes disables the latter.
+ */
+region_t simplify_region(const region_t& region, int max_boxes, double max_overdraw);
 }
 
 wlr_box wlr_box_from_pixman_box(const pixman_box32_t& box);
@@ -5,6 +5,11 @@
 #include <wayfire/object.hpp>
 #include <wayfire/region.hpp>
 
+namespace OpenGL
+{
+class program_t;
+}
+
 namespace wf
 {
 /* Effect hooks provide the plugins with a way to execute custom code
@@ -51,6 +56,36 @@ enum output_effect_type_t
 using post_hook_t = std::function<void (wf::auxilliary_buffer_t& source,
     const wf::render_buffer_t& destination)>;
 
+/**
+ * Post stages are a lighter alternative to post hooks for effects which compute each pixel only from the
+ * pixel at the same position, for example color filters.
+ *
+ * The stages of an output are compiled into a single fragment shader, so they are applied in a single pass
+ * regardless of their number. Moreover, only the damaged parts of the output are processed, while post hooks
+ * always process the whole output. As a consequence, plugins have to damage the output when the result of
+ * their stage changes, for example when an option changes.
+ *
+ * Post stages are applied after all post hooks, and they are supported only by the GLES renderer.
+ */
+struct post_stage_t
+{
+    /**
+     * The GLSL ES 1.00 source code of the stage. It has to define a function
+     * `highp vec4 @stage@process(highp vec4 color)` which returns the processed color of a pixel, and may
+     * declare uniforms and helper functions as well. The `@stage@` prefix is replaced by a prefix unique to
+     * the stage, and should be used for all names declared by the stage.
+     *
+     * The source must not change while the stage is added to an output.
+     */
+    std::string source;
+
+    /**
+     * Set the uniforms declared by the stage in the combined program. @prefix is the value of `@stage@` for
+     * this stage.
+     */
+    std::function<void (OpenGL::program_t& program, const std::string& prefix)> set_uniforms;
+};
+
 /**
  * The frame-done signal is emitted on an output when the frame has been completed (regardless of whether new
  * content was painted or not).
@@ -58,6 +93,77 @@ using post_hook_t = std::function<void (wf::auxilliary_buffer_t& source,
 struct frame_done_signal
 {};
 
+/**
+ * The output-damage signal is emitted on an output whenever a part of it is damaged, be it by a node of the
+ * scenegraph visible on the output (for example when a surface commits new contents), by
+ * render_manager::damage() and render_manager::damage_whole(), or by the backend.
+ */
+struct output_damage_signal
+{
+    /** The damaged region, in output-buffer-local coordinates. */
+    wf::region_t region;
+};
+
+/**
+ * Timing information about a single frame painted by the render manager.
+ * All durations are in microseconds.
+ */
+struct frame_timing_t
+{
+    /** Time spent in OUTPUT_EFFECT_PRE hooks. */
+    int64_t effects_pre     = 0;
+    /** Time spent in OUTPUT_EFFECT_DAMAGE hooks. */
+    int64_t effects_damage  = 0;
+    /** Time spent scheduling the render instructions and recording the commands of the main render pass. */
+    int64_t render = 0;
+    /** Time spent in OUTPUT_EFFECT_OVERLAY hooks. */
+    int64_t effects_overlay = 0;
+    /** Time spent submitting the main render pass to the renderer. */
+    int64_t submit = 0;
+    /** Time spent in OUTPUT_EFFECT_PASS_DONE hooks and post hooks. */
+    int64_t postprocessing  = 0;
+    /** Time spent rendering software cursors. */
+    int64_t sw_cursors = 0;
+    /** Time spent committing the frame to the output. */
+    int64_t swap  = 0;
+    /** Time spent in OUTPUT_EFFECT_POST hooks. */
+    int64_t effects_post = 0;
+    /** Total time spent painting the frame. */
+    int64_t total = 0;
+    /** The repaint delay (in milliseconds) used for the frame. */
+    int repaint_delay = 0;
+    /** Number of boxes of the frame damage, before and after merging fragmented damage. */
+    int damage_rects = 0;
+    int simplified_damage_rects = 0;
+    /** Number of offscreen passes avoided by fusing stacked view transformers. */
+    int fused_transformer_passes = 0;
+};
+
+/**
+ * Statistics about the frames of an output.
+ */
+struct frame_statistics_t
+{
+    /** Timings of the most recently painted frames, oldest first. */
+    std::vector<frame_timing_t> frames;
+    /** Number of frames painted since the output was created. */
+    uint64_t painted_frames = 0;
+    /** Number of frames which were directly scanned out. */
+    uint64_t scanout_frames = 0;
+    /** Number of frame events where nothing needed to be repainted. */
+    uint64_t skipped_frames = 0;
+    /** Number of frames which were not ready in time for the next vblank. */
+    uint64_t missed_frames  = 0;
+    /** Total number of boxes of the damage of all painted frames, before and after merging fragmented
+     * damage. */
+    uint64_t damage_rects   = 0;
+    uint64_t simplified_damage_rects = 0;
+    /** Total number of offscreen passes avoided by fusing stacked view transformers. */
+    uint64_t fused_transformer_passes = 0;
+    /** The current repaint delay in milliseconds. */
+    int repaint_delay = 0;
+};
+
 /** Render manager
  *
  * Each output has a render manager, which is responsible for all rendering
@@ -122,6 +228,20 @@ class render_manager
      */
     void rem_post(post_hook_t *hook);
 
+    /**
+     * Add a new post stage, which is applied after the stages added before it.
+     *
+     * @param stage The stage to add. It must stay alive until it is removed.
+     */
+    void add_post_stage(post_stage_t *stage);
+
+    /**
+     * Remove a post stage. No-op if the stage isn't active.
+     *
+     * @param stage The stage to remove.
+     */
+    void rem_post_stage(post_stage_t *stage);
+
     /**
      * @return The damaged region on the current output for the current
      * frame that is used when swapping buffers. This function should
@@ -188,12 +308,30 @@ class render_manager
      */
     wf::render_target_t get_target_framebuffer() const;
 
+    /**
+     * Render only a part of the output, scaled up to fill the whole output, for example to magnify it.
+     * Nodes outside of the region are not rendered, and their damage does not cause repaints.
+     *
+     * While a region is set, get_target_framebuffer() has the region as its geometry and a correspondingly
+     * bigger scale, and direct scanout is disabled. The region is reset when the output configuration
+     * changes.
+     *
+     * @param region The part of the output to render, in output-local coordinates, or std::nullopt to render
+     *   the whole output. Its height is adjusted to match the aspect ratio of the output.
+     */
+    void set_render_region(std::optional<wf::geometry_t> region);
+
     /**
      * Inform Wayfire whether a depth buffer is required for rendering on the default framebuffer for each
      * output.
      */
     void set_require_depth_buffer(bool require);
 
+    /**
+     * Get timing statistics about the recently painted frames on the output.
+     */
+    frame_statistics_t get_frame_statistics() const;
+
   public:
     class impl;
     std::unique_ptr<impl> pimpl;
@@ -75,6 +75,7 @@ struct render_instruction_t
 class render_instance_t
 {
   public:
+    render_instance_t();
     virtual ~render_instance_t() = default;
 
     /**
@@ -230,5 +231,26 @@ struct node_regen_instances_signal
 {};
 
 uint32_t optimize_nested_render_instances(wf::scene::node_ptr node, uint32_t flags);
+
+/**
+ * Statistics about the (re)generation of render instances.
+ * They can be used to verify that scenegraph updates do not regenerate more render instances than necessary.
+ */
+struct render_instance_stats_t
+{
+    /** The total number of render instances created so far. */
+    uint64_t instances_created = 0;
+    /** The number of render instances created during the last scenegraph update (see scene::update()). */
+    uint64_t instances_created_last_update = 0;
+    /** How many times a render instance manager regenerated all of its instances. */
+    uint64_t full_regenerations = 0;
+    /** How many times a structure node regenerated the instances of a part of its children. */
+    uint64_t partial_regenerations = 0;
+};
+
+/**
+ * Get the render instance statistics since startup.
+ */
+const render_instance_stats_t& get_render_instance_stats();
 }
 }
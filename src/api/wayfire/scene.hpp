@@ -170,6 +170,19 @@ class node_t : public std::enable_shared_from_this<node_t>,
      */
     virtual std::optional<input_node_t> find_node_at(const wf::pointf_t& at);
 
+    /**
+     * Whether find_node_at() of this node can return a result only for points inside of the node's
+     * bounding box.
+     *
+     * Nodes with many children build an index of their children's bounding boxes, which allows them to skip
+     * children whose bounding box does not contain the input point without calling their find_node_at().
+     * This can only be done for children whose input is bounded.
+     *
+     * By default, nodes are assumed to accept input anywhere (for example, input grab nodes), so that the
+     * index is always safe.
+     */
+    virtual bool has_bounded_input();
+
     /**
      * Figure out which node should receive keyboard focus on the given output.
      *
@@ -379,6 +392,12 @@ class node_t : public std::enable_shared_from_this<node_t>,
     std::vector<std::shared_ptr<node_t>> children;
 
     void set_children_unchecked(std::vector<node_ptr> new_list);
+
+  private:
+    // A cached spatial index of the children, used by find_node_at().
+    struct input_index_t;
+    std::unique_ptr<input_index_t> input_index;
+    friend void invalidate_input_index(node_t *node);
 };
 
 /**
@@ -406,6 +425,15 @@ class floating_inner_node_t : public node_t
      * children is updated, and each child's parent is set to this node.
      */
     bool set_children_list(std::vector<node_ptr> new_list);
+
+    /**
+     * If core/incremental_render_instances is enabled, the render instances of structure nodes keep a
+     * separate list of render instances for each child, so that updates to the list of children regenerate
+     * only the render instances of the changed children. Otherwise, the default node_t behavior is used.
+     */
+    void gen_render_instances(std::vector<render_instance_uptr>& instances,
+        damage_callback push_damage, wf::output_t *output) override;
+    uint32_t optimize_update(uint32_t flags) override;
 };
 using floating_inner_ptr = std::shared_ptr<floating_inner_node_t>;
 
@@ -537,5 +565,15 @@ void set_node_enabled(wf::scene::node_ptr node, bool enabled);
  * @param flags A bit mask consisting of flags defined in the @update_flag enum.
  */
 void update(node_ptr changed_node, uint32_t flags);
+
+/**
+ * Invalidate the cached indices used for hit-testing (see node_t::has_bounded_input()) of the given node and
+ * all of its ancestors. This is needed whenever the bounding box of the node changes.
+ *
+ * Scenegraph updates with the CHILDREN_LIST, ENABLED or GEOMETRY flags invalidate the indices automatically,
+ * and so do view transformers whose bounding box changes. Plugins typically do not need to call this
+ * function.
+ */
+void invalidate_input_index(node_t *node);
 }
 } // namespace wf
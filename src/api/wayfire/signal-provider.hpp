@@ -4,6 +4,7 @@
 #include <memory>
 #include <cassert>
 #include <typeindex>
+#include <cstdint>
 
 namespace wf
 {
@@ -134,7 +135,7 @@ class provider_t
     template<class SignalType>
     void connect(connection_t<SignalType> *callback)
     {
-        connect_base(index<SignalType>(), callback);
+        connect_base(signal_id<SignalType>(), callback);
     }
 
     /** Unregister a connection. */
@@ -144,11 +145,10 @@ class provider_t
     template<class SignalType>
     void emit(SignalType *data)
     {
-        this->for_each_connection(index<SignalType>(), [&] (connection_base_t *tc)
+        this->for_each_connection(signal_id<SignalType>(), [&] (connection_base_t *tc)
         {
-            auto real_type = dynamic_cast<connection_t<SignalType>*>(tc);
-            assert(real_type);
-            real_type->emit(data);
+            // Connections are stored by the id of their signal type, so the cast is always valid.
+            static_cast<connection_t<SignalType>*>(tc)->emit(data);
         });
     }
 
@@ -164,14 +164,22 @@ class provider_t
     provider_t& operator =(provider_t&& other) = delete;
 
   private:
+    /**
+     * Get a dense integer id for the given signal type. The ids are assigned by core on first use, so that
+     * core and all plugins use the same id for the same signal type.
+     */
     template<class SignalType>
-    static inline std::type_index index()
+    static inline uint32_t signal_id()
     {
-        return std::type_index(typeid(SignalType));
+        // Cache the id, as hashing the type on every emit is expensive.
+        static const uint32_t id = register_signal_type(std::type_index(typeid(SignalType)));
+        return id;
     }
 
-    void connect_base(std::type_index type, connection_base_t *callback);
-    void for_each_connection(std::type_index type, std::function<void(connection_base_t*)> func);
+    static uint32_t register_signal_type(std::type_index type);
+
+    void connect_base(uint32_t signal_id, connection_base_t *callback);
+    void for_each_connection(uint32_t signal_id, std::function<void(connection_base_t*)> func);
     void disconnect_other_side(connection_base_t *callback);
 
     struct impl;
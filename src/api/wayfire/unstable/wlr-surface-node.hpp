@@ -73,6 +73,12 @@ class wlr_surface_node_t : public node_t, public zero_copy_texturable_node_t
     void apply_current_surface_state();
     void send_frame_done(bool delay_until_vblank);
 
+    /**
+     * @return Whether the surface is currently hidden on all outputs it is shown on, and therefore receives
+     *   frame callbacks only at the rate set by workarounds/hidden_surface_frame_interval.
+     */
+    bool is_throttled();
+
   private:
     std::unique_ptr<pointer_interaction_t> ptr_interaction;
     std::unique_ptr<touch_interaction_t> tch_interaction;
@@ -83,6 +89,13 @@ class wlr_surface_node_t : public node_t, public zero_copy_texturable_node_t
     wf::signal::connection_t<wf::output_removed_signal> on_output_remove;
 
     class wlr_surface_render_instance_t;
+    std::vector<wlr_surface_render_instance_t*> live_instances;
+    bool is_commit_visible(wf::output_t *output, const wf::region_t& damage);
+
+    // Delivers frame callbacks at a throttled rate when commits are not visible on any output.
+    wf::wl_timer<false> hidden_frame_timer;
+    void schedule_hidden_frame_done();
+
     void handle_enter(wf::output_t *output);
     void handle_leave(wf::output_t *output);
     void update_pending_outputs();
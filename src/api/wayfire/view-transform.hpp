@@ -148,6 +148,19 @@ class transformer_render_instance_t : public render_instance_t
     wf::output_t *_shown_on;
     damage_callback _push_damage;
 
+    // Transformer parameters are often changed without a scenegraph update (for example by animations),
+    // but such changes are always accompanied by damage, which is when we check for a new bounding box.
+    wf::geometry_t last_bounding_box = {0, 0, 0, 0};
+    void check_bounding_box()
+    {
+        auto bbox = self->get_bounding_box();
+        if (bbox != last_bounding_box)
+        {
+            last_bounding_box = bbox;
+            wf::scene::invalidate_input_index(self.get());
+        }
+    }
+
     wf::signal::connection_t<node_regen_instances_signal> on_regen_instances = [=] (auto)
     {
         regen_instances();
@@ -168,6 +181,7 @@ class transformer_render_instance_t : public render_instance_t
 
         regen_instances();
         self->connect(&on_regen_instances);
+        last_bounding_box = self->get_bounding_box();
     }
 
     void regen_instances()
@@ -177,6 +191,7 @@ class transformer_render_instance_t : public render_instance_t
             self->cached_damage |= region;
             transform_damage_region(region);
             _push_damage(region);
+            check_bounding_box();
         };
 
         children.clear();
@@ -439,6 +454,43 @@ enum transformer_z_order_t
     TRANSFORMER_BLUR      = 1000,
 };
 
+namespace scene
+{
+/**
+ * @return The total number of offscreen render passes which were avoided so far by rendering stacked
+ *   view_2d_transformer_t and view_3d_transformer_t nodes in a single step.
+ */
+uint64_t get_fused_transformer_passes();
+
+/**
+ * Combine the transform matrices of a chain of stacked transformers into a single matrix.
+ *
+ * Each transformer renders its children to a flat buffer, so the z coordinate is dropped between the
+ * stages of the chain, which matters for transformers with a perspective projection.
+ *
+ * @param chain The matrices of the transformers, from the topmost to the bottommost one.
+ */
+glm::mat4 fuse_transform_matrices(const std::vector<glm::mat4>& chain);
+
+/**
+ * @return The matrix which maps the children of a view_3d_transformer_t to its parent's coordinate
+ *   system, before the perspective division.
+ *
+ * @param box The bounding box of the children of the transformer.
+ * @param total_transform The result of view_3d_transformer_t::calculate_total_transform().
+ */
+glm::mat4 get_3d_transform_matrix(wf::geometry_t box, const glm::mat4& total_transform);
+
+/**
+ * Transform a point like view_3d_transformer_t::to_global().
+ *
+ * @param box The bounding box of the children of the transformer.
+ * @param total_transform The result of view_3d_transformer_t::calculate_total_transform().
+ */
+wf::pointf_t apply_3d_transform(wf::geometry_t box, const glm::mat4& total_transform,
+    const wf::pointf_t& point);
+}
+
 // Calculate a bounding box after applying the node transformation to @box,
 // assuming an affine transformation applied by the node.
 wf::geometry_t get_bbox_for_node(scene::node_ptr node, wf::geometry_t box);
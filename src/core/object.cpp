@@ -6,9 +6,34 @@
 
 struct wf::signal::provider_t::impl
 {
-    std::unordered_map<std::type_index, wf::safe_list_t<connection_base_t*>> typed_connections;
+    using connection_list_t = wf::safe_list_t<connection_base_t*>;
+
+    // Providers usually have connections for only a few signal types, so a small array indexed by the
+    // signal id is faster than a hash map. The lists are allocated separately, because they have to stay at
+    // the same address while they are being iterated over.
+    std::vector<std::pair<uint32_t, std::unique_ptr<connection_list_t>>> typed_connections;
+
+    connection_list_t *find(uint32_t signal_id)
+    {
+        for (auto& [id, list] : typed_connections)
+        {
+            if (id == signal_id)
+            {
+                return list.get();
+            }
+        }
+
+        return nullptr;
+    }
 };
 
+uint32_t wf::signal::provider_t::register_signal_type(std::type_index type)
+{
+    static std::unordered_map<std::type_index, uint32_t> signal_ids;
+    auto it = signal_ids.try_emplace(type, signal_ids.size()).first;
+    return it->second;
+}
+
 wf::signal::provider_t::provider_t()
 {
     this->priv = std::make_unique<impl>();
@@ -18,7 +43,7 @@ wf::signal::provider_t::~provider_t()
 {
     for (auto& [id, connected] : priv->typed_connections)
     {
-        connected.for_each([&] (connection_base_t *base) { disconnect_other_side(base); });
+        connected->for_each([&] (connection_base_t *base) { disconnect_other_side(base); });
     }
 }
 
@@ -28,16 +53,26 @@ void wf::signal::provider_t::disconnect_other_side(connection_base_t *callback)
     callback->connected_to.erase(it, callback->connected_to.end());
 }
 
-void wf::signal::provider_t::connect_base(std::type_index idx, connection_base_t *callback)
+void wf::signal::provider_t::connect_base(uint32_t signal_id, connection_base_t *callback)
 {
-    priv->typed_connections[idx].push_back(callback);
+    auto list = priv->find(signal_id);
+    if (!list)
+    {
+        priv->typed_connections.emplace_back(signal_id, std::make_unique<impl::connection_list_t>());
+        list = priv->typed_connections.back().second.get();
+    }
+
+    list->push_back(callback);
     callback->connected_to.push_back(this);
 }
 
 void wf::signal::provider_t::for_each_connection(
-    std::type_index type, std::function<void(connection_base_t*)> func)
+    uint32_t signal_id, std::function<void(connection_base_t*)> func)
 {
-    priv->typed_connections[type].for_each(func);
+    if (auto list = priv->find(signal_id))
+    {
+        list->for_each(func);
+    }
 }
 
 void wf::signal::connection_base_t::disconnect()
@@ -54,7 +89,7 @@ void wf::signal::provider_t::disconnect(connection_base_t *callback)
     disconnect_other_side(callback);
     for (auto& [id, connected] : priv->typed_connections)
     {
-        connected.remove_all(callback);
+        connected->remove_all(callback);
     }
 }
 
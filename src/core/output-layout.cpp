@@ -272,7 +272,7 @@ void transfer_views(wf::output_t *from, wf::output_t *to)
     // Note that all views in workspace sets will have their output reassigned automatically by the
     // workspace-set impl.
     std::vector<std::shared_ptr<wf::view_interface_t>> non_ws_views;
-    for (auto& view : wf::get_core().get_all_views())
+    for (auto& view : wf::tracking_allocator_t<wf::view_interface_t>::get().get_all())
     {
         if ((view->get_output() == from) && (!toplevel_cast(view) || !toplevel_cast(view)->get_wset()))
         {
@@ -1,9 +1,11 @@
+#include <cmath>
 #include <limits>
 #include <memory>
 #include <wayfire/scene.hpp>
 #include <wayfire/view.hpp>
 #include <wayfire/output.hpp>
 #include <algorithm>
+#include <unordered_map>
 
 #include "scene-priv.hpp"
 #include "wayfire/geometry.hpp"
@@ -43,14 +45,6 @@ bool keyboard_focus_node_t::operator <(const keyboard_focus_node_t& other) const
 namespace scene
 {
 // ---------------------------------- node_t -----------------------------------
-node_t::~node_t()
-{}
-
-node_t::node_t(bool is_structure)
-{
-    this->_is_structure = is_structure;
-}
-
 void node_t::set_enabled(bool is_active)
 {
     enabled_counter += (is_active ? 1 : -1);
@@ -72,17 +66,169 @@ std::string node_t::stringify_flags() const
     return "(" + fl + ")";
 }
 
+/**
+ * A uniform grid over the bounding boxes of a node's children.
+ *
+ * Each cell contains the indices of all children whose bounding box intersects the cell, in the order of the
+ * children list (top to bottom), so that a lookup has to check only the children in a single cell.
+ * Children without bounded input are added to every cell.
+ */
+struct node_t::input_index_t
+{
+    // Nodes with fewer children simply iterate over all of them.
+    static constexpr size_t MIN_CHILDREN = 8;
+    static constexpr int MAX_GRID_SIZE   = 16;
+
+    struct entry_t
+    {
+        node_t *node;
+        wf::geometry_t bbox;
+        bool bounded;
+    };
+
+    // Set when the bounding box of a child (or any node below it) may have changed.
+    bool dirty = true;
+    std::vector<entry_t> entries;
+
+    wf::geometry_t extents = {0, 0, 0, 0};
+    int grid_size = 1;
+    std::vector<std::vector<uint32_t>> cells;
+    // Children to check for points outside of the extents.
+    std::vector<uint32_t> outside;
+
+    void rebuild(const std::vector<node_ptr>& children)
+    {
+        entries.clear();
+        outside.clear();
+        dirty = false;
+
+        int min_x = std::numeric_limits<int>::max();
+        int min_y = std::numeric_limits<int>::max();
+        int max_x = std::numeric_limits<int>::min();
+        int max_y = std::numeric_limits<int>::min();
+
+        for (auto& ch : children)
+        {
+            entry_t entry;
+            entry.node    = ch.get();
+            entry.bounded = ch->has_bounded_input();
+            entry.bbox    = entry.bounded ? ch->get_bounding_box() : wf::geometry_t{0, 0, 0, 0};
+            if (entry.bounded && (entry.bbox.width > 0) && (entry.bbox.height > 0))
+            {
+                min_x = std::min(min_x, entry.bbox.x);
+                min_y = std::min(min_y, entry.bbox.y);
+                max_x = std::max(max_x, entry.bbox.x + entry.bbox.width);
+                max_y = std::max(max_y, entry.bbox.y + entry.bbox.height);
+            }
+
+            entries.push_back(entry);
+        }
+
+        extents = (min_x <= max_x) ? wf::geometry_t{min_x, min_y, max_x - min_x, max_y - min_y} :
+            wf::geometry_t{0, 0, 0, 0};
+        grid_size = std::clamp((int)std::ceil(std::sqrt(entries.size())), 1, MAX_GRID_SIZE);
+        cells.assign(grid_size * grid_size, {});
+
+        for (uint32_t i = 0; i < entries.size(); i++)
+        {
+            auto& entry = entries[i];
+            if (!entry.bounded)
+            {
+                outside.push_back(i);
+                for (auto& cell : cells)
+                {
+                    cell.push_back(i);
+                }
+
+                continue;
+            }
+
+            if ((entry.bbox.width <= 0) || (entry.bbox.height <= 0))
+            {
+                // Cannot receive input at all.
+                continue;
+            }
+
+            auto [x1, y1] = cell_at(entry.bbox.x, entry.bbox.y);
+            auto [x2, y2] = cell_at(entry.bbox.x + entry.bbox.width - 1, entry.bbox.y + entry.bbox.height - 1);
+            for (int cy = y1; cy <= y2; cy++)
+            {
+                for (int cx = x1; cx <= x2; cx++)
+                {
+                    cells[cy * grid_size + cx].push_back(i);
+                }
+            }
+        }
+    }
+
+    std::pair<int, int> cell_at(double x, double y) const
+    {
+        int cx = std::floor((x - extents.x) * grid_size / std::max(extents.width, 1));
+        int cy = std::floor((y - extents.y) * grid_size / std::max(extents.height, 1));
+        return {std::clamp(cx, 0, grid_size - 1), std::clamp(cy, 0, grid_size - 1)};
+    }
+
+    const std::vector<uint32_t>& candidates(const wf::pointf_t& at) const
+    {
+        if (!(extents & at))
+        {
+            return outside;
+        }
+
+        auto [cx, cy] = cell_at(at.x, at.y);
+        return cells[cy * grid_size + cx];
+    }
+};
+
+node_t::~node_t()
+{}
+
+node_t::node_t(bool is_structure)
+{
+    this->_is_structure = is_structure;
+}
+
 std::optional<input_node_t> node_t::find_node_at(const wf::pointf_t& at)
 {
     auto local = this->to_local(at);
-    for (auto& node : get_children())
+    if (children.size() < input_index_t::MIN_CHILDREN)
+    {
+        for (auto& node : get_children())
+        {
+            if (!node->is_enabled())
+            {
+                continue;
+            }
+
+            auto child_node = node->find_node_at(local);
+            if (child_node.has_value())
+            {
+                return child_node;
+            }
+        }
+
+        return {};
+    }
+
+    if (!input_index)
+    {
+        input_index = std::make_unique<input_index_t>();
+    }
+
+    if (input_index->dirty || (input_index->entries.size() != children.size()))
+    {
+        input_index->rebuild(children);
+    }
+
+    for (auto idx : input_index->candidates(local))
     {
-        if (!node->is_enabled())
+        auto& entry = input_index->entries[idx];
+        if (!entry.node->is_enabled() || (entry.bounded && !(entry.bbox & local)))
         {
             continue;
         }
 
-        auto child_node = node->find_node_at(local);
+        auto child_node = entry.node->find_node_at(local);
         if (child_node.has_value())
         {
             return child_node;
@@ -92,6 +238,22 @@ std::optional<input_node_t> node_t::find_node_at(const wf::pointf_t& at)
     return {};
 }
 
+bool node_t::has_bounded_input()
+{
+    return false;
+}
+
+void invalidate_input_index(node_t *node)
+{
+    for (; node; node = node->parent())
+    {
+        if (node->input_index)
+        {
+            node->input_index->dirty = true;
+        }
+    }
+}
+
 wf::keyboard_focus_node_t node_t::keyboard_refocus(wf::output_t *output)
 {
     wf::keyboard_focus_node_t result;
@@ -116,11 +278,6 @@ wf::keyboard_focus_node_t node_t::keyboard_refocus(wf::output_t *output)
     return result;
 }
 
-bool floating_inner_node_t::set_children_list(std::vector<node_ptr> new_list)
-{
-    set_children_unchecked(std::move(new_list));
-    return true;
-}
 
 void node_t::set_children_unchecked(std::vector<node_ptr> new_list)
 {
@@ -139,6 +296,7 @@ void node_t::set_children_unchecked(std::vector<node_ptr> new_list)
     }
 
     this->children = std::move(new_list);
+    invalidate_input_index(this);
 
     data.region |= get_bounding_box();
     this->emit(&data);
@@ -236,6 +394,217 @@ class default_render_instance_t : public render_instance_t
     }
 };
 
+static render_instance_stats_t instance_stats;
+
+render_instance_t::render_instance_t()
+{
+    instance_stats.instances_created++;
+    instance_stats.instances_created_last_update++;
+}
+
+const render_instance_stats_t& get_render_instance_stats()
+{
+    return instance_stats;
+}
+
+static bool incremental_instances_enabled()
+{
+    // Render instances generated in the two modes cannot be mixed, so the option is read only once.
+    static const bool incremental = wf::option_wrapper_t<bool>{"core/incremental_render_instances"};
+    return incremental;
+}
+
+/**
+ * A render instance for structure nodes which keeps the render instances of each child in a separate list.
+ *
+ * When the node's children change, only the instances of new children, or children whose subtree changed,
+ * are regenerated. The instances of all other children are reused as they are.
+ */
+class nested_render_instance_t : public default_render_instance_t
+{
+  protected:
+    struct child_instances_t
+    {
+        std::weak_ptr<node_t> node;
+        std::vector<render_instance_uptr> instances;
+        bool dirty = false;
+    };
+
+    node_t *self;
+    wf::output_t *shown_on;
+    damage_callback push_damage_children;
+    std::vector<child_instances_t> children;
+
+    /**
+     * Whether the instance keeps itself up-to-date when the list of children of its node changes.
+     * In this case, parent instances do not need to regenerate it on CHILDREN_LIST updates.
+     */
+    bool incremental;
+
+    wf::signal::connection_t<node_regen_instances_signal> on_regen_instances = [=] (auto)
+    {
+        regen_children();
+    };
+
+    wf::signal::connection_t<node_update_signal> on_self_update = [=] (node_update_signal *ev)
+    {
+        if (ev->flags & update_flag::CHILDREN_LIST)
+        {
+            regen_children();
+        }
+    };
+
+    wf::signal::connection_t<node_update_signal> on_child_update = [=] (node_update_signal *ev)
+    {
+        for (auto& ch : children)
+        {
+            if (ch.node.lock().get() != ev->node)
+            {
+                continue;
+            }
+
+            if ((ev->flags & update_flag::ENABLED) ||
+                ((ev->flags & update_flag::CHILDREN_LIST) && !maintains_itself(ch)))
+            {
+                ch.dirty = true;
+            }
+        }
+    };
+
+    static bool maintains_itself(const child_instances_t& child)
+    {
+        if (child.instances.size() != 1)
+        {
+            return false;
+        }
+
+        auto nested = dynamic_cast<nested_render_instance_t*>(child.instances.front().get());
+        return nested && nested->incremental && (nested->self == child.node.lock().get());
+    }
+
+    void regen_children()
+    {
+        std::unordered_map<node_t*, size_t> old_index;
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            if (auto node = children[i].node.lock())
+            {
+                old_index[node.get()] = i;
+            }
+        }
+
+        size_t regenerated = 0;
+        std::vector<child_instances_t> new_children;
+        new_children.reserve(self->get_children().size());
+        on_child_update.disconnect();
+
+        for (auto& ch : self->get_children())
+        {
+            ch->connect(&on_child_update);
+            auto it = old_index.find(ch.get());
+            if ((it != old_index.end()) && !children[it->second].dirty)
+            {
+                new_children.push_back(std::move(children[it->second]));
+                continue;
+            }
+
+            child_instances_t group;
+            group.node = ch;
+            if (ch->is_enabled())
+            {
+                ch->gen_render_instances(group.instances, push_damage_children, shown_on);
+            }
+
+            new_children.push_back(std::move(group));
+            ++regenerated;
+        }
+
+        if (!children.empty())
+        {
+            instance_stats.partial_regenerations++;
+            LOGC(RENDER, "Regenerated instances of ", regenerated, " out of ", new_children.size(),
+                " children of ", self->stringify());
+        }
+
+        children = std::move(new_children);
+    }
+
+    template<class Callback>
+    void for_each_child_instance(Callback&& callback)
+    {
+        for (auto& ch : children)
+        {
+            for (auto& instance : ch.instances)
+            {
+                callback(instance);
+            }
+        }
+    }
+
+  public:
+    nested_render_instance_t(node_t *self, damage_callback push_damage, wf::output_t *shown_on) :
+        default_render_instance_t(self, push_damage)
+    {
+        this->self     = self;
+        this->shown_on = shown_on;
+        this->push_damage_children = push_damage;
+        this->incremental = incremental_instances_enabled();
+
+        regen_children();
+        self->connect(&on_regen_instances);
+        if (incremental)
+        {
+            self->connect(&on_self_update);
+        }
+    }
+
+    void schedule_instructions(std::vector<render_instruction_t>& instructions,
+        const wf::render_target_t& target, wf::region_t& damage) override
+    {
+        for_each_child_instance([&] (auto& ch)
+        {
+            ch->schedule_instructions(instructions, target, damage);
+        });
+    }
+
+    void presentation_feedback(wf::output_t *output) override
+    {
+        for_each_child_instance([&] (auto& ch)
+        {
+            ch->presentation_feedback(output);
+        });
+    }
+
+    direct_scanout try_scanout(wf::output_t *output) override
+    {
+        direct_scanout result = direct_scanout::SKIP;
+        for (auto& ch : children)
+        {
+            result = try_scanout_from_list(ch.instances, output);
+            if (result != direct_scanout::SKIP)
+            {
+                break;
+            }
+        }
+
+        return result;
+    }
+
+    void compute_visibility(wf::output_t *output, wf::region_t& visible) override
+    {
+        compute_visibility_with_offset(output, visible, {0, 0});
+    }
+
+    void compute_visibility_with_offset(wf::output_t *output, wf::region_t& visible,
+        const wf::point_t& offset)
+    {
+        for (auto& ch : children)
+        {
+            compute_visibility_from_list(ch.instances, output, visible, offset);
+        }
+    }
+};
+
 void node_t::gen_render_instances(std::vector<render_instance_uptr> & instances,
     damage_callback push_damage, wf::output_t *output)
 {
@@ -293,6 +662,38 @@ uint32_t node_t::optimize_update(uint32_t flags)
     return flags;
 }
 
+// --------------------------- floating_inner_node_t -----------------------------
+bool floating_inner_node_t::set_children_list(std::vector<node_ptr> new_list)
+{
+    set_children_unchecked(std::move(new_list));
+    return true;
+}
+
+void floating_inner_node_t::gen_render_instances(std::vector<render_instance_uptr>& instances,
+    damage_callback push_damage, wf::output_t *output)
+{
+    if (is_structure_node() && incremental_instances_enabled())
+    {
+        // Structure nodes typically have many children (outputs, views, etc.), so we keep a separate list
+        // of instances for each child and regenerate only the children which actually changed.
+        instances.push_back(std::make_unique<nested_render_instance_t>(this, push_damage, output));
+    } else
+    {
+        node_t::gen_render_instances(instances, push_damage, output);
+    }
+}
+
+uint32_t floating_inner_node_t::optimize_update(uint32_t flags)
+{
+    flags = node_t::optimize_update(flags);
+    if (is_structure_node() && incremental_instances_enabled())
+    {
+        return optimize_nested_render_instances(shared_from_this(), flags);
+    }
+
+    return flags;
+}
+
 // ------------------------------ output_node_t --------------------------------
 
 struct output_node_t::priv_t
@@ -395,31 +796,21 @@ std::optional<input_node_t> output_node_t::find_node_at(const wf::pointf_t& at)
     return node_t::find_node_at(at);
 }
 
-class output_render_instance_t : public default_render_instance_t
+class output_render_instance_t : public nested_render_instance_t
 {
     output_node_t *self;
-    std::vector<render_instance_uptr> children;
 
   public:
     output_render_instance_t(output_node_t *self, damage_callback callback,
         wf::output_t *output, wf::output_t *shown_on) :
-        default_render_instance_t(self, transform_damage(callback))
+        nested_render_instance_t(self, transform_damage(self, callback), shown_on)
     {
-        this->self = self;
-
         // Children are stored as a sublist, because we need to translate every
         // time between global and output-local geometry.
-        for (auto& child : self->get_children())
-        {
-            if (child->is_enabled())
-            {
-                child->gen_render_instances(children,
-                    transform_damage(callback), shown_on);
-            }
-        }
+        this->self = self;
     }
 
-    damage_callback transform_damage(damage_callback child_damage)
+    static damage_callback transform_damage(output_node_t *self, damage_callback child_damage)
     {
         return [=] (const wf::region_t& damage)
         {
@@ -469,11 +860,7 @@ class output_render_instance_t : public default_render_instance_t
         wf::render_target_t new_target = target.translated(-offset);
 
         damage += -offset;
-        for (auto& ch : children)
-        {
-            ch->schedule_instructions(instructions, new_target, damage);
-        }
-
+        nested_render_instance_t::schedule_instructions(instructions, new_target, damage);
         damage += offset;
     }
 
@@ -486,22 +873,13 @@ class output_render_instance_t : public default_render_instance_t
             return direct_scanout::SKIP;
         }
 
-        for (auto& ch : children)
-        {
-            auto res = ch->try_scanout(scanout);
-            if (res != direct_scanout::SKIP)
-            {
-                return res;
-            }
-        }
-
-        return direct_scanout::SKIP;
+        return nested_render_instance_t::try_scanout(scanout);
     }
 
     void compute_visibility(wf::output_t *output, wf::region_t& visible) override
     {
         auto offset = wf::origin(output->get_layout_geometry());
-        compute_visibility_from_list(children, output, visible, offset);
+        compute_visibility_with_offset(output, visible, offset);
     }
 };
 
@@ -584,7 +962,28 @@ void set_node_enabled(wf::scene::node_ptr node, bool enabled)
     }
 }
 
+static void update_recursive(node_ptr changed_node, uint32_t flags);
+
 void update(node_ptr changed_node, uint32_t flags)
+{
+    // Updates may be triggered recursively from signal handlers, count them as a part of the outermost one.
+    static int update_depth = 0;
+    if (update_depth == 0)
+    {
+        instance_stats.instances_created_last_update = 0;
+    }
+
+    if (flags & (update_flag::CHILDREN_LIST | update_flag::ENABLED | update_flag::GEOMETRY))
+    {
+        invalidate_input_index(changed_node.get());
+    }
+
+    ++update_depth;
+    update_recursive(changed_node, flags);
+    --update_depth;
+}
+
+static void update_recursive(node_ptr changed_node, uint32_t flags)
 {
     if ((flags & update_flag::CHILDREN_LIST) ||
         (flags & update_flag::ENABLED) ||
@@ -620,7 +1019,7 @@ void update(node_ptr changed_node, uint32_t flags)
             flags |= update_flag::MASKED;
         }
 
-        update(changed_node->parent()->shared_from_this(), flags);
+        update_recursive(changed_node->parent()->shared_from_this(), flags);
     }
 }
 
@@ -699,6 +1098,7 @@ render_instance_manager_t::render_instance_manager_t(std::vector<node_ptr> nodes
 
 void render_instance_manager_t::regen_instances()
 {
+    instance_stats.full_regenerations++;
     instances.clear();
     for (auto& node : nodes)
     {
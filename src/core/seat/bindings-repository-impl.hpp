@@ -2,8 +2,10 @@
 
 #include "wayfire/bindings-repository.hpp"
 #include "hotspot-manager.hpp"
+#include "key-binding-index.hpp"
 #include "wayfire/signal-definitions.hpp"
 #include <wayfire/debug.hpp>
+#include <algorithm>
 
 struct wf::bindings_repository_t::impl
 {
@@ -28,15 +30,89 @@ struct wf::bindings_repository_t::impl
 
     void reparse_extensions();
 
+    /**
+     * Get the index of key bindings, rebuilding it if bindings were added, removed or changed since it was
+     * last built.
+     *
+     * The returned index stays valid even if the bindings change while it is in use (e.g. a key callback
+     * removes bindings).
+     */
+    std::shared_ptr<const key_binding_index_t> get_key_index()
+    {
+        if (!key_index)
+        {
+            key_index = std::make_shared<key_binding_index_t>(keys, activators);
+        }
+
+        return key_index;
+    }
+
+    void invalidate_key_index()
+    {
+        key_index.reset();
+    }
+
+    /**
+     * Start tracking changes of a binding option, so that the key index can be rebuilt when it changes.
+     */
+    template<class Option>
+    void track_option(const wf::option_sptr_t<Option>& option)
+    {
+        option->add_updated_handler(&on_binding_option_updated);
+        invalidate_key_index();
+    }
+
+    /**
+     * Stop tracking changes of a binding option, if it is no longer used by any key or activator binding.
+     */
+    template<class Option>
+    void untrack_option(const wf::option_sptr_t<Option>& option)
+    {
+        auto uses_option = [&] (const auto& container)
+        {
+            return std::any_of(container.begin(), container.end(), [&] (const auto& binding)
+            {
+                return (void*)binding->activated_by.get() == (void*)option.get();
+            });
+        };
+
+        if (!uses_option(keys) && !uses_option(activators))
+        {
+            option->rem_updated_handler(&on_binding_option_updated);
+        }
+
+        invalidate_key_index();
+    }
+
+    ~impl()
+    {
+        for (auto& binding : keys)
+        {
+            binding->activated_by->rem_updated_handler(&on_binding_option_updated);
+        }
+
+        for (auto& binding : activators)
+        {
+            binding->activated_by->rem_updated_handler(&on_binding_option_updated);
+        }
+    }
+
     binding_container_t<wf::keybinding_t, key_callback> keys;
     binding_container_t<wf::keybinding_t, axis_callback> axes;
     binding_container_t<wf::buttonbinding_t, button_callback> buttons;
     binding_container_t<wf::activatorbinding_t, activator_callback> activators;
 
     hotspot_manager_t hotspot_mgr;
+    std::shared_ptr<const key_binding_index_t> key_index;
+
+    wf::config::option_base_t::updated_callback_t on_binding_option_updated = [=] ()
+    {
+        invalidate_key_index();
+    };
 
     wf::signal::connection_t<wf::reload_config_signal> on_config_reload = [=] (wf::reload_config_signal *ev)
     {
+        invalidate_key_index();
         recreate_hotspots();
         reparse_extensions();
     };
@@ -24,6 +24,7 @@ wf::bindings_repository_t::~bindings_repository_t()
 void wf::bindings_repository_t::add_key(option_sptr_t<keybinding_t> key, wf::key_callback *cb)
 {
     push_binding(priv->keys, key, cb);
+    priv->track_option(key);
 }
 
 void wf::bindings_repository_t::add_axis(option_sptr_t<keybinding_t> axis, wf::axis_callback *cb)
@@ -40,6 +41,7 @@ void wf::bindings_repository_t::add_activator(
     option_sptr_t<activatorbinding_t> activator, wf::activator_callback *cb)
 {
     push_binding(priv->activators, activator, cb);
+    priv->track_option(activator);
     if (activator->get_value().get_hotspots().size())
     {
         priv->recreate_hotspots();
@@ -54,50 +56,35 @@ bool wf::bindings_repository_t::handle_key(const wf::keybinding_t& pressed,
         return false;
     }
 
-    std::vector<std::function<bool()>> callbacks;
-    for (auto& binding : this->priv->keys)
+    // Hold a reference to the index, as callbacks may add or remove bindings.
+    auto index   = priv->get_key_index();
+    auto matches = index->find(pressed);
+    if (!matches)
     {
-        if (binding->activated_by->get_value() == pressed)
-        {
-            /* We must be careful because the callback might be erased,
-             * so force copy the callback into the lambda */
-            auto callback = binding->callback;
-            callbacks.emplace_back([pressed, callback] ()
-            {
-                return (*callback)(pressed);
-            });
-        }
+        return false;
     }
 
-    for (auto& binding : this->priv->activators)
+    bool handled = false;
+    for (auto& entry : *matches)
     {
-        if (binding->activated_by->get_value().has_match(pressed))
+        if (entry.key)
         {
-            /* We must be careful because the callback might be erased,
-             * so force copy the callback into the lambda */
-            auto callback = binding->callback;
-            callbacks.emplace_back([pressed, callback, mod_binding_key] ()
-            {
-                wf::activator_data_t ev = {
-                    .source = activator_source_t::KEYBINDING,
-                    .activation_data = pressed.get_key()
-                };
+            handled |= (*entry.key)(pressed);
+            continue;
+        }
 
-                if (mod_binding_key)
-                {
-                    ev.source = activator_source_t::MODIFIERBINDING;
-                    ev.activation_data = mod_binding_key;
-                }
+        wf::activator_data_t ev = {
+            .source = activator_source_t::KEYBINDING,
+            .activation_data = pressed.get_key()
+        };
 
-                return (*callback)(ev);
-            });
+        if (mod_binding_key)
+        {
+            ev.source = activator_source_t::MODIFIERBINDING;
+            ev.activation_data = mod_binding_key;
         }
-    }
 
-    bool handled = false;
-    for (auto& cb : callbacks)
-    {
-        handled |= cb();
+        handled |= (*entry.activator)(ev);
     }
 
     return handled;
@@ -258,11 +245,39 @@ void wf::bindings_repository_t::rem_binding(void *callback)
         update_hotspots |= !act->activated_by->get_value().get_hotspots().empty();
     }
 
+    std::vector<option_sptr_t<keybinding_t>> removed_keys;
+    std::vector<option_sptr_t<activatorbinding_t>> removed_activators;
+    for (auto& binding : priv->keys)
+    {
+        if (binding->callback == callback)
+        {
+            removed_keys.push_back(binding->activated_by);
+        }
+    }
+
+    for (auto& binding : priv->activators)
+    {
+        if (binding->callback == callback)
+        {
+            removed_activators.push_back(binding->activated_by);
+        }
+    }
+
     erase(priv->keys);
     erase(priv->buttons);
     erase(priv->axes);
     erase(priv->activators);
 
+    for (auto& opt : removed_keys)
+    {
+        priv->untrack_option(opt);
+    }
+
+    for (auto& opt : removed_activators)
+    {
+        priv->untrack_option(opt);
+    }
+
     if (update_hotspots)
     {
         priv->recreate_hotspots();
@@ -0,0 +1,85 @@
+#include "key-binding-index.hpp"
+#include <wayfire/config/types.hpp>
+
+static uint64_t index_key(const wf::keybinding_t& binding)
+{
+    return ((uint64_t)binding.get_modifiers() << 32) | binding.get_key();
+}
+
+/**
+ * Find all key combinations an activator binding can be triggered by.
+ *
+ * The activatorbinding_t does not expose its key bindings directly, so we parse them from the string
+ * representation of the activator, which has the form "binding1 | binding2 | ...".
+ */
+static std::vector<wf::keybinding_t> get_activator_keys(const wf::activatorbinding_t& activator)
+{
+    std::vector<wf::keybinding_t> keys;
+
+    const std::string value = wf::option_type::to_string(activator);
+    size_t start = 0;
+    while (start <= value.size())
+    {
+        size_t end = value.find('|', start);
+        if (end == std::string::npos)
+        {
+            end = value.size();
+        }
+
+        std::string part = value.substr(start, end - start);
+        auto first = part.find_first_not_of(" \t");
+        auto last  = part.find_last_not_of(" \t");
+        if (first != std::string::npos)
+        {
+            auto key = wf::option_type::from_string<wf::keybinding_t>(part.substr(first, last - first + 1));
+            // Double-check so that the index never triggers a binding which a linear search would not.
+            if (key && activator.has_match(*key))
+            {
+                keys.push_back(*key);
+            }
+        }
+
+        start = end + 1;
+    }
+
+    return keys;
+}
+
+wf::key_binding_index_t::key_binding_index_t(const keys_t& keys, const activators_t& activators)
+{
+    for (auto& binding : keys)
+    {
+        add(binding->activated_by->get_value(), entry_t{.key = binding->callback});
+    }
+
+    for (auto& binding : activators)
+    {
+        auto activator_keys = get_activator_keys(binding->activated_by->get_value());
+        for (size_t i = 0; i < activator_keys.size(); i++)
+        {
+            // The same key combination might be listed multiple times, but should trigger the binding once
+            bool duplicate = false;
+            for (size_t j = 0; j < i; j++)
+            {
+                duplicate |= (activator_keys[j] == activator_keys[i]);
+            }
+
+            if (!duplicate)
+            {
+                add(activator_keys[i], entry_t{.activator = binding->callback});
+            }
+        }
+    }
+}
+
+void wf::key_binding_index_t::add(const keybinding_t& binding, entry_t entry)
+{
+    index[index_key(binding)].push_back(entry);
+}
+
+const std::vector<wf::key_binding_index_t::entry_t>*wf::key_binding_index_t::find(
+    const keybinding_t& pressed) const
+{
+    auto it = index.find(index_key(pressed));
+    return (it == index.end()) ? nullptr : &it->second;
+}
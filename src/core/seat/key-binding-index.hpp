@@ -0,0 +1,45 @@
+#pragma once
+
+#include "hotspot-manager.hpp"
+#include <unordered_map>
+#include <vector>
+
+namespace wf
+{
+/**
+ * An index of all key bindings and activator bindings which can be triggered by a key combination,
+ * keyed by the modifiers and the key of the combination.
+ * A part of the bindings_repository_t.
+ *
+ * The index does not track changes to the bindings or their options, it has to be rebuilt instead.
+ */
+class key_binding_index_t
+{
+  public:
+    /** A binding triggered by a key combination. Exactly one of the callbacks is set. */
+    struct entry_t
+    {
+        key_callback *key = nullptr;
+        activator_callback *activator = nullptr;
+    };
+
+    using keys_t = binding_container_t<keybinding_t, key_callback>;
+    using activators_t = binding_container_t<activatorbinding_t, activator_callback>;
+
+    /**
+     * Build the index from the current values of the given bindings.
+     * For each key combination, key bindings come before activator bindings, and bindings of the same
+     * type are in the order they were registered, matching the order of a linear search.
+     */
+    key_binding_index_t(const keys_t& keys, const activators_t& activators);
+
+    /**
+     * @return The bindings matching the given key combination, or nullptr if there are none.
+     */
+    const std::vector<entry_t> *find(const keybinding_t& pressed) const;
+
+  private:
+    std::unordered_map<uint64_t, std::vector<entry_t>> index;
+    void add(const keybinding_t& binding, entry_t entry);
+};
+}
@@ -1,20 +1,11 @@
 #include "wayfire/signal-provider.hpp"
 #include "wayfire/txn/transaction.hpp"
 #include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 #include <wayfire/txn/transaction-manager.hpp>
 #include <wayfire/debug.hpp>
 
-static bool transactions_intersect(const wf::txn::transaction_uptr& a, const wf::txn::transaction_uptr& b)
-{
-    const auto& obj_a = a->get_objects();
-    const auto& obj_b = b->get_objects();
-
-    return std::any_of(obj_a.begin(), obj_a.end(), [&] (const wf::txn::transaction_object_sptr& x)
-    {
-        return std::find(obj_b.begin(), obj_b.end(), x) != obj_b.end();
-    });
-}
-
 struct wf::txn::transaction_manager_t::impl
 {
     impl()
@@ -39,42 +30,44 @@ struct wf::txn::transaction_manager_t::impl
 
     void coalesce_transactions(const transaction_uptr& tx)
     {
-        while (true)
+        // Pending transactions never share objects, so for each object in tx (including the ones added
+        // while merging), there is at most one pending transaction which needs to be merged.
+        for (size_t i = 0; i < tx->get_objects().size(); i++)
         {
-            bool size_changed = false;
-            for (auto& existing : pending)
+            auto it = pending_objects.find(tx->get_objects()[i].get());
+            if ((it == pending_objects.end()) || merged_transactions.count(it->second))
             {
-                if (transactions_intersect(existing, tx))
-                {
-                    const size_t start_size = tx->get_objects().size();
-                    for (auto& obj : existing->get_objects())
-                    {
-                        tx->add_object(obj);
-                    }
-
-                    if (start_size != tx->get_objects().size())
-                    {
-                        LOGC(TXN, "Merged transaction ", existing.get(), " into ", tx.get());
-                        size_changed = true;
-                    }
-                }
+                continue;
             }
 
-            if (!size_changed)
+            transaction_t *existing = it->second;
+            merged_transactions.insert(existing);
+            for (auto& obj : existing->get_objects())
             {
-                // No new objects were added in the last iteration => done
-                break;
+                tx->add_object(obj);
             }
+
+            LOGC(TXN, "Merged transaction ", existing, " into ", tx.get());
         }
     }
 
     void remove_conflicts(const transaction_uptr& tx)
     {
-        auto it = std::remove_if(pending.begin(), pending.end(), [&] (const transaction_uptr& existing)
+        if (!merged_transactions.empty())
         {
-            return transactions_intersect(existing, tx);
-        });
-        pending.erase(it, pending.end());
+            auto it = std::remove_if(pending.begin(), pending.end(), [&] (const transaction_uptr& existing)
+            {
+                return merged_transactions.count(existing.get());
+            });
+            pending.erase(it, pending.end());
+            merged_transactions.clear();
+        }
+
+        // All objects of the merged transactions are part of tx now.
+        for (auto& obj : tx->get_objects())
+        {
+            pending_objects[obj.get()] = tx.get();
+        }
     }
 
     // Try to commit as many transactions as possible
@@ -102,14 +95,21 @@ struct wf::txn::transaction_manager_t::impl
 
     bool can_commit_transaction(const transaction_uptr& tx)
     {
-        return std::none_of(committed.begin(), committed.end(), [&] (const transaction_uptr& comm)
+        const auto& objects = tx->get_objects();
+        return std::none_of(objects.begin(), objects.end(), [&] (const transaction_object_sptr& obj)
         {
-            return transactions_intersect(tx, comm);
+            return committed_objects.count(obj.get());
         });
     }
 
     void do_commit(transaction_uptr tx)
     {
+        for (auto& obj : tx->get_objects())
+        {
+            pending_objects.erase(obj.get());
+            committed_objects[obj.get()] = tx.get();
+        }
+
         tx->connect(&on_tx_apply);
         committed.push_back(std::move(tx));
         // Note: this might immediately trigger tx_apply if all objects are already ready!
@@ -121,6 +121,14 @@ struct wf::txn::transaction_manager_t::impl
     std::vector<transaction_uptr> pending;
     wf::wl_idle_call idle_clear_done;
 
+    // Indices of the objects in the pending and committed transactions. Pending transactions are merged
+    // when they share objects and a transaction is committed only if it has no objects in common with
+    // already committed transactions, so each object is part of at most one pending and one committed
+    // transaction.
+    std::unordered_map<transaction_object_t*, transaction_t*> pending_objects;
+    std::unordered_map<transaction_object_t*, transaction_t*> committed_objects;
+    std::unordered_set<transaction_t*> merged_transactions;
+
     wf::signal::connection_t<transaction_applied_signal> on_tx_apply = [&] (transaction_applied_signal *ev)
     {
         // Move transactions which are done from committed to done.
@@ -131,6 +139,10 @@ struct wf::txn::transaction_manager_t::impl
         });
 
         wf::dassert(it != committed.end(), "Transaction not found in committed list");
+        for (auto& obj : ev->self->get_objects())
+        {
+            committed_objects.erase(obj.get());
+        }
 
         done.push_back(std::move(*it));
         committed.erase(it);
@@ -26,24 +26,12 @@ void wf::txn::transaction_manager_t::schedule_object(transaction_object_sptr obj
     schedule_transaction(std::move(tx));
 }
 
-template<class T>
-static bool is_contained(const std::vector<T>& objs, const T& object)
-{
-    return std::find(objs.begin(), objs.end(), object) != objs.end();
-}
-
 bool wf::txn::transaction_manager_t::is_object_pending(transaction_object_sptr object) const
 {
-    return std::any_of(this->priv->pending.begin(), this->priv->pending.end(), [&] (auto& pending)
-    {
-        return is_contained(pending->get_objects(), object);
-    });
+    return priv->pending_objects.count(object.get());
 }
 
 bool wf::txn::transaction_manager_t::is_object_committed(transaction_object_sptr object) const
 {
-    return std::any_of(this->priv->committed.begin(), this->priv->committed.end(), [&] (auto& committed)
-    {
-        return is_contained(committed->get_objects(), object);
-    });
+    return priv->committed_objects.count(object.get());
 }
@@ -11,13 +11,20 @@
 #include "wayfire/scene.hpp"
 #include "wayfire/signal-definitions.hpp"
 #include "wayfire/view.hpp"
+#include "wayfire/view-transform.hpp"
 #include "wayfire/output.hpp"
 #include "wayfire/util.hpp"
 #include "../main.hpp"
 #include "wayfire/workspace-set.hpp" // IWYU pragma: keep
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
 #include <filesystem>
 #include <fstream>
+#include <iterator>
+#include <optional>
+#include <tuple>
 #include <wayfire/nonstd/reverse.hpp>
 #include <wayfire/nonstd/safe-list.hpp>
 #include <wayfire/util/log.hpp>
@@ -34,6 +41,8 @@ namespace wf
 struct swapchain_damage_manager_t
 {
     wf::option_wrapper_t<bool> force_frame_sync{"workarounds/force_frame_sync"};
+    wf::option_wrapper_t<int> damage_max_rects{"core/damage_max_rects"};
+    wf::option_wrapper_t<double> damage_max_overdraw{"core/damage_max_overdraw"};
     wf::wl_listener_wrapper on_needs_frame;
     wf::wl_listener_wrapper on_damage;
     wf::wl_listener_wrapper on_gamma_changed;
@@ -133,6 +142,10 @@ struct swapchain_damage_manager_t
         {
             schedule_repaint();
         }
+
+        wf::output_damage_signal ev;
+        ev.region = region;
+        wo->emit(&ev);
     }
 
     void damage_buffer(const wf::geometry_t& box, bool repaint)
@@ -149,6 +162,10 @@ struct swapchain_damage_manager_t
         {
             schedule_repaint();
         }
+
+        wf::output_damage_signal ev;
+        ev.region = box;
+        wo->emit(&ev);
     }
 
     int constant_redraw_counter = 0;
@@ -325,6 +342,19 @@ struct swapchain_damage_manager_t
         }
     }
 
+    /**
+     * Merge the boxes of the damage of the current frame if it is too fragmented, so that fewer
+     * scissored draws are needed to repaint it. See wf::simplify_region().
+     *
+     * @return The number of boxes before and after the simplification.
+     */
+    std::pair<int, int> simplify_frame_damage()
+    {
+        const int before = std::distance(frame_damage.begin(), frame_damage.end());
+        frame_damage = wf::simplify_region(frame_damage, damage_max_rects, damage_max_overdraw);
+        return {before, (int)std::distance(frame_damage.begin(), frame_damage.end())};
+    }
+
     /**
      * Return the damage that has been scheduled for the next frame up to now,
      * or, if in a repaint, the damage for the current frame
@@ -421,6 +451,41 @@ struct effect_hook_manager_t
     }
 };
 
+static const char *post_stage_vertex_shader =
+    R"(
+#version 100
+
+attribute highp vec2 position;
+attribute highp vec2 uvPosition;
+
+varying highp vec2 uvpos;
+
+void main() {
+    gl_Position = vec4(position.xy, 0.0, 1.0);
+    uvpos = uvPosition;
+}
+)";
+
+static const char *post_stage_fragment_header =
+    R"(
+#version 100
+
+varying highp vec2 uvpos;
+uniform sampler2D smp;
+)";
+
+static std::string replace_all(std::string source, const std::string& from, const std::string& to)
+{
+    size_t pos = 0;
+    while ((pos = source.find(from, pos)) != std::string::npos)
+    {
+        source.replace(pos, from.length(), to);
+        pos += to.length();
+    }
+
+    return source;
+}
+
 /**
  * A class to manage and run postprocessing effects
  */
@@ -428,10 +493,15 @@ struct postprocessing_manager_t
 {
     using post_container_t = wf::safe_list_t<post_hook_t*>;
     post_container_t post_effects;
-    wf::auxilliary_buffer_t post_buffers[2];
+    wf::auxilliary_buffer_t post_buffers[3];
     /* Buffer to which other operations render to */
     static constexpr uint32_t default_out_buffer = 0;
 
+    /* Post stages, applied in a single pass after the post hooks */
+    std::vector<post_stage_t*> post_stages;
+    OpenGL::program_t stage_program;
+    bool stage_program_dirty = true;
+
     output_t *output;
     uint32_t output_width, output_height;
     postprocessing_manager_t(output_t *output)
@@ -439,6 +509,19 @@ struct postprocessing_manager_t
         this->output = output;
     }
 
+    ~postprocessing_manager_t()
+    {
+        wf::gles::run_in_context_if_gles([&]
+        {
+            stage_program.free_resources();
+        });
+    }
+
+    bool has_post_processing() const
+    {
+        return (post_effects.size() > 0) || !post_stages.empty();
+    }
+
     wf::render_buffer_t final_target;
     void set_current_buffer(wlr_buffer *buffer)
     {
@@ -450,16 +533,25 @@ struct postprocessing_manager_t
 
     void allocate(int width, int height)
     {
-        if (post_effects.size() == 0)
+        if (!has_post_processing())
         {
             return;
         }
 
         output_width  = width;
         output_height = height;
-        for (auto& buffer : post_buffers)
+
+        // The last post hook renders directly to the screen, unless it is followed by post stages.
+        const size_t intermediate = post_effects.size() - (post_stages.empty() ? 1 : 0);
+        for (size_t i = 0; i < std::size(post_buffers); i++)
         {
-            buffer.allocate({width, height});
+            if (i <= std::min<size_t>(intermediate, 2))
+            {
+                post_buffers[i].allocate({width, height});
+            } else
+            {
+                post_buffers[i].free();
+            }
         }
     }
 
@@ -475,41 +567,152 @@ struct postprocessing_manager_t
         output->render->damage_whole_idle();
     }
 
+    void add_post_stage(post_stage_t *stage)
+    {
+        post_stages.push_back(stage);
+        stage_program_dirty = true;
+        output->render->damage_whole_idle();
+    }
+
+    void rem_post_stage(post_stage_t *stage)
+    {
+        auto it = std::remove(post_stages.begin(), post_stages.end(), stage);
+        if (it != post_stages.end())
+        {
+            post_stages.erase(it, post_stages.end());
+            stage_program_dirty = true;
+            output->render->damage_whole_idle();
+        }
+    }
+
+    static std::string get_stage_prefix(size_t index)
+    {
+        return "stage" + std::to_string(index) + "_";
+    }
+
+    /* Combine the sources of all stages into a single program. */
+    void update_stage_program()
+    {
+        if (!stage_program_dirty)
+        {
+            return;
+        }
+
+        std::string fragment = post_stage_fragment_header;
+        std::string main = "void main()\n{\n    highp vec4 color = texture2D(smp, uvpos);\n";
+        for (size_t i = 0; i < post_stages.size(); i++)
+        {
+            const auto prefix = get_stage_prefix(i);
+            fragment += replace_all(post_stages[i]->source, "@stage@", prefix) + "\n";
+            main     += "    color = " + prefix + "process(color);\n";
+        }
+
+        fragment += main + "    gl_FragColor = color;\n}\n";
+        stage_program.set_simple(OpenGL::compile_program(post_stage_vertex_shader, fragment));
+        stage_program_dirty = false;
+    }
+
+    /* Apply all post stages to the damaged region of @source, and render the result to the screen. */
+    void run_post_stages(wf::auxilliary_buffer_t& source, const wf::region_t& damage)
+    {
+        static const float vertexData[] = {
+            -1.0f, -1.0f,
+            1.0f, -1.0f,
+            1.0f, 1.0f,
+            -1.0f, 1.0f
+        };
+
+        static const float coordData[] = {
+            0.0f, 0.0f,
+            1.0f, 0.0f,
+            1.0f, 1.0f,
+            0.0f, 1.0f
+        };
+
+        wf::gles::run_in_context([&]
+        {
+            update_stage_program();
+            wf::gles::bind_render_buffer(final_target);
+            stage_program.use(wf::TEXTURE_TYPE_RGBA);
+            GL_CALL(glActiveTexture(GL_TEXTURE0));
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, wf::gles_texture_t::from_aux(source).tex_id));
+
+            stage_program.attrib_pointer("position", 2, 0, vertexData);
+            stage_program.attrib_pointer("uvPosition", 2, 0, coordData);
+            stage_program.uniform1i("smp", 0);
+            for (size_t i = 0; i < post_stages.size(); i++)
+            {
+                if (post_stages[i]->set_uniforms)
+                {
+                    post_stages[i]->set_uniforms(stage_program, get_stage_prefix(i));
+                }
+            }
+
+            GL_CALL(glDisable(GL_BLEND));
+            for (auto& box : damage)
+            {
+                wf::gles::scissor_render_buffer(final_target, wlr_box_from_pixman_box(box));
+                GL_CALL(glDrawArrays(GL_TRIANGLE_FAN, 0, 4));
+            }
+
+            GL_CALL(glDisable(GL_SCISSOR_TEST));
+            GL_CALL(glEnable(GL_BLEND));
+            GL_CALL(glBindTexture(GL_TEXTURE_2D, 0));
+            stage_program.deactivate();
+        });
+    }
+
     /* Run all postprocessing effects, rendering to alternating buffers and
      * finally to the screen.
      *
      * NB: 2 buffers just aren't enough. We render to the zero buffer, and then
      * we alternately render to the second and the third. The reason: We track
-     * damage. So, we need to keep the whole buffer each frame. */
-    void run_post_effects()
+     * damage. So, we need to keep the whole buffer each frame.
+     *
+     * @param damage The damaged region of the screen, in buffer-local coordinates. */
+    void run_post_effects(const wf::region_t& damage)
     {
         int cur_idx = 0;
         post_effects.for_each([&] (auto post) -> void
         {
-            int next_idx = 1 - cur_idx;
-            wf::render_buffer_t dst_buffer = (post == post_effects.back() ?
+            int next_idx = (cur_idx == 1) ? 2 : 1;
+            wf::render_buffer_t dst_buffer = ((post == post_effects.back()) && post_stages.empty() ?
                 final_target : post_buffers[next_idx].get_renderbuffer());
             (*post)(post_buffers[cur_idx], dst_buffer);
             cur_idx = next_idx;
         });
+
+        if (!post_stages.empty())
+        {
+            run_post_stages(post_buffers[cur_idx], damage);
+        }
     }
 
+    /* The part of the output which is rendered scaled up to the whole framebuffer, see
+     * render_manager::set_render_region(). */
+    std::optional<wf::geometry_t> render_region;
+
     wf::render_target_t get_target_framebuffer() const
     {
         wf::render_target_t fb{
-            post_effects.size() > 0 ? post_buffers[default_out_buffer].get_renderbuffer() : final_target
+            has_post_processing() ? post_buffers[default_out_buffer].get_renderbuffer() : final_target
         };
 
         fb.geometry     = output->get_relative_geometry();
         fb.wl_transform = output->handle->transform;
         fb.scale = output->handle->scale;
+        if (render_region)
+        {
+            fb.scale   *= 1.0 * fb.geometry.width / render_region->width;
+            fb.geometry = *render_region;
+        }
 
         return fb;
     }
 
     bool can_scanout() const
     {
-        return post_effects.size() == 0;
+        return !has_post_processing() && !render_region;
     }
 };
 
@@ -696,7 +899,15 @@ struct repaint_delay_manager_t
         const int64_t refresh = this->refresh_nsec / 1e6;
         const int64_t on_time_thresh = refresh * 1.5;
         const int64_t last_frame_len = get_current_time() - last_pageflip;
-        if (last_frame_len <= on_time_thresh)
+        if (last_frame_len > on_time_thresh)
+        {
+            ++missed_frames;
+        }
+
+        if (is_adaptive())
+        {
+            update_adaptive_delay(last_frame_len <= on_time_thresh);
+        } else if (last_frame_len <= on_time_thresh)
         {
             // We rendered last frame on time
             if (get_current_time() - last_increase >= increase_window)
@@ -744,9 +955,66 @@ struct repaint_delay_manager_t
         return delay;
     }
 
+    /**
+     * Whether the repaint delay is calculated from the measured cost of the last frames instead of
+     * core/max_render_time.
+     */
+    bool is_adaptive()
+    {
+        return (std::string)scheduling_mode == "adaptive";
+    }
+
+    /**
+     * Record the cost of a painted frame (CPU and, if available, GPU time) in microseconds.
+     * Used in adaptive mode to compute the delay for the next frames.
+     */
+    void report_frame_cost(int64_t cost_usec)
+    {
+        frame_costs[next_cost] = cost_usec;
+        next_cost = (next_cost + 1) % frame_costs.size();
+        num_costs = std::min(num_costs + 1, frame_costs.size());
+    }
+
+    /**
+     * The number of frames which were not rendered in time for the next vblank.
+     */
+    uint64_t missed_frames = 0;
+
   private:
     int delay = 0;
 
+    /**
+     * In adaptive mode, the repaint is started just early enough that a frame with the 95th percentile
+     * of the recently measured costs (plus a safety margin) finishes before the next vblank.
+     * The safety margin grows exponentially when frames are missed and shrinks slowly otherwise.
+     */
+    void update_adaptive_delay(bool last_on_time)
+    {
+        if (last_on_time)
+        {
+            safety_margin = std::max(MIN_SAFETY_MARGIN, safety_margin - SAFETY_MARGIN_DECAY);
+        } else
+        {
+            safety_margin = std::min(safety_margin * 2, MAX_SAFETY_MARGIN);
+        }
+
+        const int64_t refresh_usec = this->refresh_nsec / 1000;
+        if ((num_costs < MIN_COST_SAMPLES) || (refresh_usec <= 0))
+        {
+            delay = 0;
+            return;
+        }
+
+        std::array<int64_t, COST_SAMPLES> sorted_costs;
+        std::copy_n(frame_costs.begin(), num_costs, sorted_costs.begin());
+        auto p95 = sorted_costs.begin() + (num_costs * 95 / 100);
+        std::nth_element(sorted_costs.begin(), p95, sorted_costs.begin() + num_costs);
+
+        const int64_t budget = *p95 + safety_margin;
+        const int64_t max_delay = std::max<int64_t>(0, refresh_usec / 1000 - 1);
+        delay = clamp<int64_t>((refresh_usec - budget) / 1000, 0, max_delay);
+    }
+
     void update_delay(int delta)
     {
         int config_delay = std::max(0,
@@ -785,13 +1053,90 @@ struct repaint_delay_manager_t
     // Time of last frame
     int64_t last_pageflip = -1; // -1 is invalid
 
-    int64_t refresh_nsec;
+    static constexpr size_t COST_SAMPLES     = 64;
+    static constexpr size_t MIN_COST_SAMPLES = 8;
+    static constexpr int64_t MIN_SAFETY_MARGIN   = 1'000; // 1ms
+    static constexpr int64_t MAX_SAFETY_MARGIN   = 8'000; // 8ms
+    static constexpr int64_t SAFETY_MARGIN_DECAY = 10; // 10us per frame on time
+    std::array<int64_t, COST_SAMPLES> frame_costs;
+    size_t next_cost = 0;
+    size_t num_costs = 0;
+    int64_t safety_margin = MIN_SAFETY_MARGIN;
+
+    int64_t refresh_nsec = 0;
     wf::option_wrapper_t<int> max_render_time{"core/max_render_time"};
     wf::option_wrapper_t<bool> dynamic_delay{"workarounds/dynamic_repaint_delay"};
+    wf::option_wrapper_t<std::string> scheduling_mode{"core/repaint_scheduling"};
 
     wf::wl_listener_wrapper on_present;
 };
 
+/**
+ * frame_timing_history_t keeps the timings of the last frames painted on an output in a ring buffer.
+ */
+struct frame_timing_history_t
+{
+    static constexpr size_t MAX_FRAMES = 512;
+
+    /**
+     * A helper for measuring the duration of consecutive phases of a frame.
+     */
+    class phase_timer_t
+    {
+        using clock = std::chrono::steady_clock;
+        clock::time_point start = clock::now();
+        clock::time_point last  = start;
+
+      public:
+        /** @return The time since the last call to lap() (or since creation) in microseconds. */
+        int64_t lap()
+        {
+            auto now = clock::now();
+            auto duration = std::chrono::duration_cast<std::chrono::microseconds>(now - last).count();
+            last = now;
+            return duration;
+        }
+
+        /** @return The time since creation in microseconds. */
+        int64_t total() const
+        {
+            return std::chrono::duration_cast<std::chrono::microseconds>(last - start).count();
+        }
+    };
+
+    void push(const frame_timing_t& timing)
+    {
+        frames[next] = timing;
+        next = (next + 1) % MAX_FRAMES;
+        count = std::min(count + 1, MAX_FRAMES);
+        ++painted_frames;
+    }
+
+    std::vector<frame_timing_t> get_frames() const
+    {
+        std::vector<frame_timing_t> result;
+        result.reserve(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            result.push_back(frames[(next + MAX_FRAMES - count + i) % MAX_FRAMES]);
+        }
+
+        return result;
+    }
+
+    uint64_t painted_frames = 0;
+    uint64_t scanout_frames = 0;
+    uint64_t skipped_frames = 0;
+    uint64_t damage_rects   = 0;
+    uint64_t simplified_damage_rects = 0;
+    uint64_t fused_transformer_passes = 0;
+
+  private:
+    std::array<frame_timing_t, MAX_FRAMES> frames;
+    size_t next  = 0;
+    size_t count = 0;
+};
+
 class wf::render_manager::impl
 {
   public:
@@ -805,6 +1150,13 @@ class wf::render_manager::impl
     std::unique_ptr<postprocessing_manager_t> postprocessing;
     std::unique_ptr<depth_buffer_manager_t> depth_buffer_manager;
     std::unique_ptr<repaint_delay_manager_t> delay_manager;
+    frame_timing_history_t frame_timings;
+
+    /* Render timer used to measure the GPU cost of the main render pass in adaptive repaint mode. */
+    wlr_render_timer *render_timer = nullptr;
+    bool render_timer_unsupported  = false;
+    /* The last painted frame whose render timer has not been read yet. */
+    std::optional<frame_timing_t> unmeasured_frame;
 
     wf::option_wrapper_t<wf::color_t> background_color_opt;
     std::unique_ptr<wf::render_pass_t> current_pass;
@@ -832,6 +1184,7 @@ class wf::render_manager::impl
                 return;
             }
 
+            report_last_frame_cost();
             delay_manager->start_frame();
 
             auto repaint_delay = delay_manager->get_delay();
@@ -856,6 +1209,7 @@ class wf::render_manager::impl
         });
 
         on_frame.connect(&output->handle->events.frame);
+        output->connect(&on_configuration_changed);
 
         background_color_opt.load_option("core/background_color");
         background_color_opt.set_callback([=] ()
@@ -879,6 +1233,46 @@ class wf::render_manager::impl
     wlr_color_transform *icc_color_transform = NULL;
     wlr_buffer_pass_options pass_opts{};
 
+    void set_render_region(std::optional<wf::geometry_t> region)
+    {
+        const auto og = output->get_relative_geometry();
+        if (region && ((region->width <= 0) || (og.width <= 0)))
+        {
+            region.reset();
+        }
+
+        if (region)
+        {
+            // Keep the aspect ratio of the output, so that the region covers the whole framebuffer.
+            region->height = std::ceil(1.0 * region->width * og.height / og.width);
+        }
+
+        if (region == postprocessing->render_region)
+        {
+            return;
+        }
+
+        postprocessing->render_region = region;
+        damage_manager->damage_whole();
+        if (damage_manager->instance_manager)
+        {
+            // Nodes outside of the region are not visible, so they can be treated as hidden.
+            const auto layout_geometry = output->get_layout_geometry();
+            damage_manager->instance_manager->set_visibility_region(
+                region ? (*region + wf::origin(layout_geometry)) : layout_geometry);
+        }
+    }
+
+    // The region is relative to the old output size, so it is most likely not valid anymore.
+    wf::signal::connection_t<wf::output_configuration_changed_signal> on_configuration_changed =
+        [=] (wf::output_configuration_changed_signal *ev)
+    {
+        if (ev && ev->changed_fields)
+        {
+            set_render_region({});
+        }
+    };
+
     void reload_icc_profile()
     {
         if (icc_profile.value().empty())
@@ -929,6 +1323,62 @@ class wf::render_manager::impl
     ~impl()
     {
         set_icc_transform(nullptr);
+        if (render_timer)
+        {
+            wlr_render_timer_destroy(render_timer);
+        }
+    }
+
+    wlr_render_timer *get_render_timer()
+    {
+        if (!delay_manager->is_adaptive() || render_timer_unsupported)
+        {
+            return nullptr;
+        }
+
+        if (!render_timer)
+        {
+            render_timer = wlr_render_timer_create(output->handle->renderer);
+            if (!render_timer)
+            {
+                LOGW("Renderer does not support render timers, adaptive repaint scheduling on ",
+                    output->to_string(), " will use CPU time only.");
+                render_timer_unsupported = true;
+            }
+        }
+
+        return render_timer;
+    }
+
+    /**
+     * Report the cost of the last painted frame to the delay manager.
+     * This is done on the next frame event, when the GPU has certainly finished rendering the frame,
+     * so that reading the render timer does not stall.
+     */
+    void report_last_frame_cost()
+    {
+        if (!unmeasured_frame.has_value())
+        {
+            return;
+        }
+
+        auto frame = unmeasured_frame.value();
+        unmeasured_frame.reset();
+
+        int64_t cost = frame.total;
+        if (render_timer)
+        {
+            // The render timer measures from the start of the render pass until the GPU finishes it,
+            // replace the CPU time of the main pass with it.
+            const int64_t gpu_nsec = wlr_render_timer_get_duration_ns(render_timer);
+            if (gpu_nsec >= 0)
+            {
+                const int64_t main_pass_cpu = frame.render + frame.effects_overlay + frame.submit;
+                cost = cost - main_pass_cpu + std::max(main_pass_cpu, gpu_nsec / 1000);
+            }
+        }
+
+        delay_manager->report_frame_cost(cost);
     }
 
     const bool env_allow_scanout;
@@ -1012,7 +1462,7 @@ class wf::render_manager::impl
         params.renderer = output->handle->renderer;
         params.flags    = RPASS_CLEAR_BACKGROUND | RPASS_EMIT_SIGNALS;
 
-        pass_opts.timer = NULL; // TODO: do we care about this? could be useful for dynamic frame scheduling
+        pass_opts.timer = get_render_timer();
         pass_opts.color_transform = icc_color_transform;
         params.pass_opts   = &pass_opts;
         this->current_pass = std::make_unique<render_pass_t>(params);
@@ -1060,14 +1510,22 @@ class wf::render_manager::impl
      */
     void paint()
     {
+        frame_timing_history_t::phase_timer_t timer;
+        frame_timing_t timing;
+        timing.repaint_delay = delay_manager->get_delay();
+        const uint64_t fused_passes_before = scene::get_fused_transformer_passes();
+
         /* Part 1: frame setup: query damage, etc. */
         effects->run_effects(OUTPUT_EFFECT_PRE);
+        timing.effects_pre = timer.lap();
         effects->run_effects(OUTPUT_EFFECT_DAMAGE);
+        timing.effects_damage = timer.lap();
 
         if (do_direct_scanout())
         {
             // Yet another optimization: if we can directly scanout, we should
             // stop the rest of the repaint cycle.
+            ++frame_timings.scanout_frames;
             return;
         }
 
@@ -1076,13 +1534,20 @@ class wf::render_manager::impl
         {
             // Optimization: the output doesn't need a new frame (so isn't damaged), so we can
             // just skip the whole repaint
+            ++frame_timings.skipped_frames;
             delay_manager->skip_frame();
             return;
         }
 
+        std::tie(timing.damage_rects, timing.simplified_damage_rects) =
+            damage_manager->simplify_frame_damage();
+        frame_timings.damage_rects += timing.damage_rects;
+        frame_timings.simplified_damage_rects += timing.simplified_damage_rects;
+
         /* Part 2: call the renderer, which sets swap_damage and draws the scenegraph */
         update_bound_output(next_frame->buffer);
         this->swap_damage = start_output_pass(next_frame);
+        timing.render = timer.lap();
 
         /* Part 3: overlay effects */
         effects->run_effects(OUTPUT_EFFECT_OVERLAY);
@@ -1091,6 +1556,8 @@ class wf::render_manager::impl
             current_pass->clear(current_pass->get_target().geometry, {0, 0, 0, 1});
         }
 
+        timing.effects_overlay = timer.lap();
+
         /* Part 4: we are done with the main scene. Submit the main render pass. */
         const bool pass_status = current_pass->submit();
         current_pass.reset();
@@ -1101,26 +1568,56 @@ class wf::render_manager::impl
             return;
         }
 
+        timing.submit = timer.lap();
         effects->run_effects(OUTPUT_EFFECT_PASS_DONE);
 
-        /* Part 5: finalize the scene: postprocessing effects */
+        /* Part 5: finalize the scene: postprocessing effects. Post hooks repaint the whole output, while
+         * post stages process only the damaged region. */
         if (postprocessing->post_effects.size())
         {
             swap_damage |= damage_manager->get_buffer_extents();
         }
 
-        postprocessing->run_post_effects();
+        postprocessing->run_post_effects(swap_damage);
+        timing.postprocessing = timer.lap();
 
         /* Part 6: render sw cursors We render software cursors after everything else
          * for consistency with hardware cursor planes */
         render_sw_cursors(next_frame.get());
+        timing.sw_cursors = timer.lap();
 
         /* Part 7: finalize frame: swap buffers, send frame_done, etc */
         damage_manager->swap_buffers(std::move(next_frame), swap_damage);
+        timing.swap = timer.lap();
 
         unset_bound_output();
         swap_damage.clear();
         post_paint();
+        timing.effects_post = timer.lap();
+
+        timing.total = timer.total();
+        timing.fused_transformer_passes = scene::get_fused_transformer_passes() - fused_passes_before;
+        frame_timings.fused_transformer_passes += timing.fused_transformer_passes;
+        frame_timings.push(timing);
+        if (delay_manager->is_adaptive())
+        {
+            unmeasured_frame = timing;
+        }
+    }
+
+    frame_statistics_t get_frame_statistics() const
+    {
+        frame_statistics_t stats;
+        stats.frames = frame_timings.get_frames();
+        stats.painted_frames = frame_timings.painted_frames;
+        stats.scanout_frames = frame_timings.scanout_frames;
+        stats.skipped_frames = frame_timings.skipped_frames;
+        stats.damage_rects   = frame_timings.damage_rects;
+        stats.simplified_damage_rects = frame_timings.simplified_damage_rects;
+        stats.fused_transformer_passes = frame_timings.fused_transformer_passes;
+        stats.missed_frames  = delay_manager->missed_frames;
+        stats.repaint_delay  = delay_manager->get_delay();
+        return stats;
     }
 
     void render_sw_cursors(swapchain_damage_manager_t::frame_object_t *next_frame)
@@ -1224,6 +1721,16 @@ void render_manager::rem_post(post_hook_t *hook)
     pimpl->postprocessing->rem_post(hook);
 }
 
+void render_manager::add_post_stage(post_stage_t *stage)
+{
+    pimpl->postprocessing->add_post_stage(stage);
+}
+
+void render_manager::rem_post_stage(post_stage_t *stage)
+{
+    pimpl->postprocessing->rem_post_stage(stage);
+}
+
 wf::region_t render_manager::get_scheduled_damage()
 {
     return pimpl->damage_manager->get_scheduled_damage(get_target_framebuffer());
@@ -1266,11 +1773,21 @@ wf::render_target_t render_manager::get_target_framebuffer() const
     return pimpl->postprocessing->get_target_framebuffer();
 }
 
+void render_manager::set_render_region(std::optional<wf::geometry_t> region)
+{
+    pimpl->set_render_region(region);
+}
+
 void render_manager::set_require_depth_buffer(bool require)
 {
     return pimpl->depth_buffer_manager->set_required(require);
 }
 
+frame_statistics_t render_manager::get_frame_statistics() const
+{
+    return pimpl->get_frame_statistics();
+}
+
 wf::render_pass_t*render_manager::get_current_pass()
 {
     return pimpl->current_pass.get();
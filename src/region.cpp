@@ -1,5 +1,9 @@
 #include <wayfire/region.hpp>
 #include <wayfire/nonstd/wlroots-full.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <vector>
 
 /* Pixman helpers */
 wlr_box wlr_box_from_pixman_box(const pixman_box32_t& box)
@@ -20,6 +24,195 @@ pixman_box32_t pixman_box_from_wlr_box(const wlr_box& box)
     };
 }
 
+/*
+ * Fast paths for simple regions.
+ *
+ * Most regions in the compositor are empty or a single rectangle. pixman
+ * already stores those inline (region.data is NULL for a single box), but
+ * every operation on them still goes through its generic band-sweeping code.
+ * The helpers below compute the result directly when both operands are
+ * simple, and return false when the operation has to be left to pixman.
+ */
+namespace
+{
+struct simple_region_t
+{
+    bool empty;
+    pixman_box32_t box;
+};
+
+bool get_simple(const pixman_region32_t *region, simple_region_t& out)
+{
+    if (region->data == nullptr)
+    {
+        out = {false, region->extents};
+        return true;
+    }
+
+    if (region->data->numRects == 0)
+    {
+        out = {true, {0, 0, 0, 0}};
+        return true;
+    }
+
+    return false;
+}
+
+simple_region_t simple_from_wlr_box(const wlr_box& box)
+{
+    if ((box.width <= 0) || (box.height <= 0))
+    {
+        return {true, {0, 0, 0, 0}};
+    }
+
+    return {false, pixman_box_from_wlr_box(box)};
+}
+
+void set_simple(pixman_region32_t *dst, const simple_region_t& region)
+{
+    if (region.empty || (region.box.x1 >= region.box.x2) || (region.box.y1 >= region.box.y2))
+    {
+        pixman_region32_clear(dst);
+        return;
+    }
+
+    pixman_region32_fini(dst);
+    dst->extents = region.box;
+    dst->data    = nullptr;
+}
+
+bool box_contains(const pixman_box32_t& a, const pixman_box32_t& b)
+{
+    return (a.x1 <= b.x1) && (a.y1 <= b.y1) && (a.x2 >= b.x2) && (a.y2 >= b.y2);
+}
+
+bool box_overlaps(const pixman_box32_t& a, const pixman_box32_t& b)
+{
+    return (a.x1 < b.x2) && (b.x1 < a.x2) && (a.y1 < b.y2) && (b.y1 < a.y2);
+}
+
+bool intersect_simple(pixman_region32_t *dst, pixman_region32_t *a, const simple_region_t& b)
+{
+    simple_region_t sa;
+    if (b.empty)
+    {
+        pixman_region32_clear(dst);
+        return true;
+    }
+
+    if (!get_simple(a, sa))
+    {
+        if (box_contains(b.box, a->extents))
+        {
+            pixman_region32_copy(dst, a);
+            return true;
+        }
+
+        return false;
+    }
+
+    if (sa.empty)
+    {
+        pixman_region32_clear(dst);
+        return true;
+    }
+
+    set_simple(dst, {false, {
+        std::max(sa.box.x1, b.box.x1), std::max(sa.box.y1, b.box.y1),
+        std::min(sa.box.x2, b.box.x2), std::min(sa.box.y2, b.box.y2),
+    }
+    });
+    return true;
+}
+
+bool union_simple(pixman_region32_t *dst, pixman_region32_t *a, const simple_region_t& b)
+{
+    simple_region_t sa;
+    if (b.empty)
+    {
+        pixman_region32_copy(dst, a);
+        return true;
+    }
+
+    if (!get_simple(a, sa))
+    {
+        return false;
+    }
+
+    if (sa.empty || box_contains(b.box, sa.box))
+    {
+        set_simple(dst, b);
+        return true;
+    }
+
+    if (box_contains(sa.box, b.box))
+    {
+        set_simple(dst, sa);
+        return true;
+    }
+
+    /* Boxes in the same row or column which overlap or touch */
+    const bool same_row = (sa.box.y1 == b.box.y1) && (sa.box.y2 == b.box.y2) &&
+        (sa.box.x1 <= b.box.x2) && (b.box.x1 <= sa.box.x2);
+    const bool same_column = (sa.box.x1 == b.box.x1) && (sa.box.x2 == b.box.x2) &&
+        (sa.box.y1 <= b.box.y2) && (b.box.y1 <= sa.box.y2);
+    if (same_row || same_column)
+    {
+        set_simple(dst, {false, {
+            std::min(sa.box.x1, b.box.x1), std::min(sa.box.y1, b.box.y1),
+            std::max(sa.box.x2, b.box.x2), std::max(sa.box.y2, b.box.y2),
+        }
+        });
+        return true;
+    }
+
+    return false;
+}
+
+bool subtract_simple(pixman_region32_t *dst, pixman_region32_t *a, const simple_region_t& b)
+{
+    simple_region_t sa;
+    if (b.empty)
+    {
+        pixman_region32_copy(dst, a);
+        return true;
+    }
+
+    if (!get_simple(a, sa))
+    {
+        if (!box_overlaps(a->extents, b.box))
+        {
+            pixman_region32_copy(dst, a);
+            return true;
+        }
+
+        return false;
+    }
+
+    if (sa.empty || box_contains(b.box, sa.box))
+    {
+        pixman_region32_clear(dst);
+        return true;
+    }
+
+    if (!box_overlaps(sa.box, b.box))
+    {
+        set_simple(dst, sa);
+        return true;
+    }
+
+    return false;
+}
+
+/* Apply the given simple operation if the other region is simple */
+template<class Op>
+bool apply_simple(Op op, pixman_region32_t *dst, pixman_region32_t *a, const pixman_region32_t *b)
+{
+    simple_region_t sb;
+    return get_simple(b, sb) && op(dst, a, sb);
+}
+}
+
 wf::region_t::region_t()
 {
     pixman_region32_init(&_region);
@@ -76,7 +269,8 @@ wf::region_t& wf::region_t::operator =(wf::region_t&& other)
 
 bool wf::region_t::empty() const
 {
-    return !pixman_region32_not_empty(this->unconst());
+    /* Same as !pixman_region32_not_empty(), without the function call */
+    return _region.data && (_region.data->numRects == 0);
 }
 
 void wf::region_t::clear()
@@ -154,27 +348,36 @@ bool wf::region_t::contains_pointf(const wf::pointf_t& point) const
 wf::region_t wf::region_t::operator +(const wf::point_t& vector) const
 {
     wf::region_t result{*this};
-    pixman_region32_translate(&result._region, vector.x, vector.y);
+    result += vector;
     return result;
 }
 
 wf::region_t& wf::region_t::operator +=(const wf::point_t& vector)
 {
-    pixman_region32_translate(&_region, vector.x, vector.y);
+    if (_region.data == nullptr)
+    {
+        _region.extents.x1 += vector.x;
+        _region.extents.x2 += vector.x;
+        _region.extents.y1 += vector.y;
+        _region.extents.y2 += vector.y;
+    } else
+    {
+        pixman_region32_translate(&_region, vector.x, vector.y);
+    }
+
     return *this;
 }
 
 wf::region_t wf::region_t::operator -(const wf::point_t& vector) const
 {
     wf::region_t result{*this};
-    pixman_region32_translate(&result._region, -vector.x, -vector.y);
+    result += wf::point_t{-vector.x, -vector.y};
     return result;
 }
 
 wf::region_t& wf::region_t::operator -=(const wf::point_t& vector)
 {
-    pixman_region32_translate(&_region, -vector.x, -vector.y);
-    return *this;
+    return *this += wf::point_t{-vector.x, -vector.y};
 }
 
 wf::region_t wf::region_t::operator *(float scale) const
@@ -196,8 +399,11 @@ wf::region_t& wf::region_t::operator *=(float scale)
 wf::region_t wf::region_t::operator &(const wlr_box& box) const
 {
     wf::region_t result;
-    pixman_region32_intersect_rect(result.to_pixman(), this->unconst(),
-        box.x, box.y, box.width, box.height);
+    if (!intersect_simple(result.to_pixman(), this->unconst(), simple_from_wlr_box(box)))
+    {
+        pixman_region32_intersect_rect(result.to_pixman(), this->unconst(),
+            box.x, box.y, box.width, box.height);
+    }
 
     return result;
 }
@@ -205,24 +411,33 @@ wf::region_t wf::region_t::operator &(const wlr_box& box) const
 wf::region_t wf::region_t::operator &(const wf::region_t& other) const
 {
     wf::region_t result;
-    pixman_region32_intersect(result.to_pixman(),
-        this->unconst(), other.unconst());
+    if (!apply_simple(intersect_simple, result.to_pixman(), this->unconst(), other.to_pixman()))
+    {
+        pixman_region32_intersect(result.to_pixman(),
+            this->unconst(), other.unconst());
+    }
 
     return result;
 }
 
 wf::region_t& wf::region_t::operator &=(const wlr_box& box)
 {
-    pixman_region32_intersect_rect(this->to_pixman(), this->to_pixman(),
-        box.x, box.y, box.width, box.height);
+    if (!intersect_simple(this->to_pixman(), this->to_pixman(), simple_from_wlr_box(box)))
+    {
+        pixman_region32_intersect_rect(this->to_pixman(), this->to_pixman(),
+            box.x, box.y, box.width, box.height);
+    }
 
     return *this;
 }
 
 wf::region_t& wf::region_t::operator &=(const wf::region_t& other)
 {
-    pixman_region32_intersect(this->to_pixman(),
-        this->to_pixman(), other.unconst());
+    if (!apply_simple(intersect_simple, this->to_pixman(), this->to_pixman(), other.to_pixman()))
+    {
+        pixman_region32_intersect(this->to_pixman(),
+            this->to_pixman(), other.unconst());
+    }
 
     return *this;
 }
@@ -231,8 +446,11 @@ wf::region_t& wf::region_t::operator &=(const wf::region_t& other)
 wf::region_t wf::region_t::operator |(const wlr_box& other) const
 {
     wf::region_t result;
-    pixman_region32_union_rect(result.to_pixman(), this->unconst(),
-        other.x, other.y, other.width, other.height);
+    if (!union_simple(result.to_pixman(), this->unconst(), simple_from_wlr_box(other)))
+    {
+        pixman_region32_union_rect(result.to_pixman(), this->unconst(),
+            other.x, other.y, other.width, other.height);
+    }
 
     return result;
 }
@@ -240,22 +458,31 @@ wf::region_t wf::region_t::operator |(const wlr_box& other) const
 wf::region_t wf::region_t::operator |(const wf::region_t& other) const
 {
     wf::region_t result;
-    pixman_region32_union(result.to_pixman(), this->unconst(), other.unconst());
+    if (!apply_simple(union_simple, result.to_pixman(), this->unconst(), other.to_pixman()))
+    {
+        pixman_region32_union(result.to_pixman(), this->unconst(), other.unconst());
+    }
 
     return result;
 }
 
 wf::region_t& wf::region_t::operator |=(const wlr_box& other)
 {
-    pixman_region32_union_rect(this->to_pixman(), this->to_pixman(),
-        other.x, other.y, other.width, other.height);
+    if (!union_simple(this->to_pixman(), this->to_pixman(), simple_from_wlr_box(other)))
+    {
+        pixman_region32_union_rect(this->to_pixman(), this->to_pixman(),
+            other.x, other.y, other.width, other.height);
+    }
 
     return *this;
 }
 
 wf::region_t& wf::region_t::operator |=(const wf::region_t& other)
 {
-    pixman_region32_union(this->to_pixman(), this->to_pixman(), other.unconst());
+    if (!apply_simple(union_simple, this->to_pixman(), this->to_pixman(), other.to_pixman()))
+    {
+        pixman_region32_union(this->to_pixman(), this->to_pixman(), other.unconst());
+    }
 
     return *this;
 }
@@ -264,8 +491,11 @@ wf::region_t& wf::region_t::operator |=(const wf::region_t& other)
 wf::region_t wf::region_t::operator ^(const wlr_box& box) const
 {
     wf::region_t result;
-    wf::region_t sub{box};
-    pixman_region32_subtract(result.to_pixman(), this->unconst(), sub.to_pixman());
+    if (!subtract_simple(result.to_pixman(), this->unconst(), simple_from_wlr_box(box)))
+    {
+        wf::region_t sub{box};
+        pixman_region32_subtract(result.to_pixman(), this->unconst(), sub.to_pixman());
+    }
 
     return result;
 }
@@ -273,25 +503,34 @@ wf::region_t wf::region_t::operator ^(const wlr_box& box) const
 wf::region_t wf::region_t::operator ^(const wf::region_t& other) const
 {
     wf::region_t result;
-    pixman_region32_subtract(result.to_pixman(),
-        this->unconst(), other.unconst());
+    if (!apply_simple(subtract_simple, result.to_pixman(), this->unconst(), other.to_pixman()))
+    {
+        pixman_region32_subtract(result.to_pixman(),
+            this->unconst(), other.unconst());
+    }
 
     return result;
 }
 
 wf::region_t& wf::region_t::operator ^=(const wlr_box& box)
 {
-    wf::region_t sub{box};
-    pixman_region32_subtract(this->to_pixman(),
-        this->to_pixman(), sub.to_pixman());
+    if (!subtract_simple(this->to_pixman(), this->to_pixman(), simple_from_wlr_box(box)))
+    {
+        wf::region_t sub{box};
+        pixman_region32_subtract(this->to_pixman(),
+            this->to_pixman(), sub.to_pixman());
+    }
 
     return *this;
 }
 
 wf::region_t& wf::region_t::operator ^=(const wf::region_t& other)
 {
-    pixman_region32_subtract(this->to_pixman(),
-        this->to_pixman(), other.unconst());
+    if (!apply_simple(subtract_simple, this->to_pixman(), this->to_pixman(), other.to_pixman()))
+    {
+        pixman_region32_subtract(this->to_pixman(),
+            this->to_pixman(), other.unconst());
+    }
 
     return *this;
 }
@@ -325,3 +564,108 @@ const pixman_box32_t*wf::region_t::end() const
 
     return data + n;
 }
+
+static int64_t box_area(const pixman_box32_t& box)
+{
+    return int64_t(box.x2 - box.x1) * (box.y2 - box.y1);
+}
+
+wf::region_t wf::simplify_region(const wf::region_t& region, int max_boxes, double max_overdraw)
+{
+    const int nboxes = std::distance(region.begin(), region.end());
+    if (nboxes <= 1)
+    {
+        return region;
+    }
+
+    /* The boxes of a pixman region do not overlap */
+    int64_t area = 0;
+    for (auto& box : region)
+    {
+        area += box_area(box);
+    }
+
+    const auto extents = region.get_extents();
+    if (box_area(extents) <= (1.0 + max_overdraw) * area)
+    {
+        return wf::region_t{wlr_box_from_pixman_box(extents)};
+    }
+
+    if ((max_boxes <= 0) || (nboxes <= max_boxes))
+    {
+        return region;
+    }
+
+    /* Every strip produces boxes with the same vertical span, so that pixman
+     * does not split them into more bands. */
+    const int rows    = std::max(1, (int)std::sqrt(max_boxes));
+    const int columns = std::max(1, max_boxes / rows);
+    const int64_t height = extents.y2 - extents.y1;
+
+    wf::region_t result;
+    std::vector<std::pair<int, int>> spans;
+    const pixman_box32_t *first = region.begin();
+    for (int r = 0; r < rows; r++)
+    {
+        const int strip_y1 = extents.y1 + height * r / rows;
+        const int strip_y2 = extents.y1 + height * (r + 1) / rows;
+
+        /* Boxes are sorted by their bands, so boxes above this strip are
+         * also above all the next ones. */
+        while ((first != region.end()) && (first->y2 <= strip_y1))
+        {
+            ++first;
+        }
+
+        int y1 = strip_y2, y2 = strip_y1;
+        spans.clear();
+        for (auto box = first; (box != region.end()) && (box->y1 < strip_y2); ++box)
+        {
+            spans.push_back({box->x1, box->x2});
+            y1 = std::min(y1, std::max(box->y1, strip_y1));
+            y2 = std::max(y2, std::min(box->y2, strip_y2));
+        }
+
+        if (spans.empty())
+        {
+            continue;
+        }
+
+        /* Merge overlapping spans, then the closest ones until there are few enough */
+        std::sort(spans.begin(), spans.end());
+        std::vector<std::pair<int, int>> merged = {spans.front()};
+        for (auto& span : spans)
+        {
+            if (span.first <= merged.back().second)
+            {
+                merged.back().second = std::max(merged.back().second, span.second);
+            } else
+            {
+                merged.push_back(span);
+            }
+        }
+
+        while ((int)merged.size() > columns)
+        {
+            size_t closest = 0;
+            for (size_t i = 1; i + 1 < merged.size(); i++)
+            {
+                if (merged[i + 1].first - merged[i].second <
+                    merged[closest + 1].first - merged[closest].second)
+                {
+                    closest = i;
+                }
+            }
+
+            merged[closest].second = merged[closest + 1].second;
+            merged.erase(merged.begin() + closest + 1);
+        }
+
+        for (auto& [x1, x2] : merged)
+        {
+            result |= wlr_box{x1, y1, x2 - x1, y2 - y1};
+        }
+    }
+
+    return result;
+}
@@ -43,7 +43,12 @@ wf::point_t wf::scene::translation_node_t::get_offset() const
 
 void wf::scene::translation_node_t::set_offset(wf::point_t offset)
 {
-    this->offset = offset;
+    if (this->offset != offset)
+    {
+        this->offset = offset;
+        // The bounding box of the node moved, so cached hit-testing indices of its parents are outdated.
+        wf::scene::invalidate_input_index(this);
+    }
 }
 
 uint32_t wf::scene::translation_node_t::optimize_update(uint32_t flags)
@@ -188,20 +188,232 @@ static void transform_linear_damage(node_t *self, wf::region_t& damage)
     }
 }
 
+static uint64_t fused_transformer_passes = 0;
+
+uint64_t get_fused_transformer_passes()
+{
+    return fused_transformer_passes;
+}
+
+glm::mat4 fuse_transform_matrices(const std::vector<glm::mat4>& chain)
+{
+    // When rendered separately, each transformer draws a flat texture, so the depth produced by the
+    // transformers below it is lost before it is applied.
+    const auto flatten = glm::scale(glm::mat4(1.0), {1, 1, 0});
+
+    glm::mat4 matrix{1.0};
+    for (size_t i = 0; i < chain.size(); i++)
+    {
+        if (i > 0)
+        {
+            matrix = matrix * flatten;
+        }
+
+        matrix = matrix * chain[i];
+    }
+
+    return matrix;
+}
+
+glm::mat4 get_3d_transform_matrix(wf::geometry_t box, const glm::mat4& total_transform)
+{
+    // The total transform works on coordinates relative to the center of the children, with the Y axis
+    // pointing up, see view_3d_transformer_t::to_global().
+    auto center = get_center(box);
+    auto to_relative = glm::scale(glm::mat4(1.0), {1, -1, 1}) *
+        glm::translate(glm::mat4(1.0), {-center.x, -center.y, 0});
+    auto from_relative = glm::translate(glm::mat4(1.0), {center.x, center.y, 0}) *
+        glm::scale(glm::mat4(1.0), {1, -1, 1});
+    return from_relative * total_transform * to_relative;
+}
+
+/**
+ * An interface for the render instances of transformers which only apply a matrix and a color multiplier to
+ * the contents of their children.
+ *
+ * Normally, each transformer renders its children to an auxiliary buffer and then renders the buffer with
+ * its own transform. When such transformers are stacked directly on top of each other, the topmost one
+ * instead renders the contents of the bottom-most one with the combined transform, so the transformers in
+ * between do not need auxiliary buffers at all.
+ */
+class fusable_transformer_instance_t
+{
+  public:
+    virtual ~fusable_transformer_instance_t() = default;
+
+    /**
+     * @return A matrix mapping the coordinates of the transformer's children to the coordinates of its parent.
+     */
+    virtual glm::mat4 get_transform_matrix() = 0;
+
+    /** @return The color multiplier applied to the contents of the children. */
+    virtual glm::vec4 get_color() = 0;
+
+    /** @return Whether the transform consists only of scaling and translation. */
+    virtual bool is_axis_aligned() = 0;
+
+    /** @return The render instance of the next transformer in the chain, if it can be fused with this one. */
+    virtual fusable_transformer_instance_t *get_fusable_child() = 0;
+
+    /** @return A texture with the contents of the children, see transformer_render_instance_t::get_texture. */
+    virtual wf::texture_t get_content_texture(float scale) = 0;
+
+    /** @return The bounding box of the children. */
+    virtual wf::geometry_t get_content_box() = 0;
+
+    /** Free the auxiliary buffer of the transformer, because it is not used when the transformer is fused. */
+    virtual void release_content_buffer() = 0;
+};
+
+template<class NodeType>
+class fusable_render_instance_t :
+    public transformer_render_instance_t<NodeType>, public fusable_transformer_instance_t
+{
+  public:
+    using transformer_render_instance_t<NodeType>::transformer_render_instance_t;
+
+    fusable_transformer_instance_t *get_fusable_child() override
+    {
+        if (this->children.size() == 1)
+        {
+            return dynamic_cast<fusable_transformer_instance_t*>(this->children.front().get());
+        }
+
+        return nullptr;
+    }
+
+    wf::texture_t get_content_texture(float scale) override
+    {
+        return this->get_texture(scale);
+    }
+
+    wf::geometry_t get_content_box() override
+    {
+        return this->self->get_children_bounding_box();
+    }
+
+    void release_content_buffer() override
+    {
+        this->self->release_buffers();
+        // The buffer is fully repainted if it is allocated again.
+        this->self->cached_damage.clear();
+    }
+
+  protected:
+    /**
+     * Try to render the chain of fusable transformers starting with this one in a single step.
+     *
+     * @return false if the chain consists only of this transformer, or cannot be fused with the current
+     *   renderer, in which case the caller should render the transformer on its own.
+     */
+    bool render_fused(const wf::scene::render_instruction_t& data)
+    {
+        std::vector<fusable_transformer_instance_t*> chain = {this};
+        bool axis_aligned = is_axis_aligned();
+        while (auto child = chain.back()->get_fusable_child())
+        {
+            chain.push_back(child);
+            axis_aligned &= child->is_axis_aligned();
+        }
+
+        // Transforms other than scaling and translation need a custom GLES subpass.
+        if ((chain.size() == 1) || (!axis_aligned && !wf::get_core().is_gles2()))
+        {
+            return false;
+        }
+
+        std::vector<glm::mat4> matrices;
+        glm::vec4 color{1.0};
+        for (auto instance : chain)
+        {
+            matrices.push_back(instance->get_transform_matrix());
+            color *= instance->get_color();
+        }
+
+        auto matrix = fuse_transform_matrices(matrices);
+
+        for (size_t i = 0; i + 1 < chain.size(); i++)
+        {
+            chain[i]->release_content_buffer();
+        }
+
+        fused_transformer_passes += chain.size() - 1;
+        auto bottom = chain.back();
+        if (axis_aligned)
+        {
+            // Like a single 2D transformer without rotation, we can use render-agnostic functions.
+            auto tex = bottom->get_content_texture(data.target.scale);
+            tex.filter_mode = WLR_SCALE_FILTER_BILINEAR;
+            data.pass->add_texture(tex, data.target, this->self->get_bounding_box(), data.damage, color.a);
+            return true;
+        }
+
+        auto full_matrix = wf::gles::render_target_orthographic_projection(data.target) * matrix;
+        data.pass->custom_gles_subpass([&]
+        {
+            auto tex  = wf::gles_texture_t{bottom->get_content_texture(data.target.scale)};
+            auto bbox = bottom->get_content_box();
+            wf::gles::bind_render_buffer(data.target);
+            for (auto& box : data.damage)
+            {
+                wf::gles::render_target_logic_scissor(data.target, wlr_box_from_pixman_box(box));
+                OpenGL::render_transformed_texture(tex, bbox, full_matrix, color);
+            }
+        });
+
+        return true;
+    }
+};
+
+static glm::mat4 get_2d_transform_matrix(view_2d_transformer_t *self)
+{
+    auto midpoint  = get_center(self->view);
+    auto center_at = glm::translate(glm::mat4(1.0),
+        {-midpoint.x, -midpoint.y, 0.0});
+    auto scale = glm::scale(glm::mat4(1.0),
+        glm::vec3{self->get_scale_x(), self->get_scale_y(), 1.0});
+    auto rotate = glm::rotate<float>(glm::mat4(1.0), -self->get_angle(),
+        glm::vec3{0.0, 0.0, 1.0});
+    auto translate = glm::translate(glm::mat4(1.0),
+        glm::vec3{self->get_translation_x() + midpoint.x,
+            self->get_translation_y() + midpoint.y, 0.0});
+    return translate * rotate * scale * center_at;
+}
+
 class view_2d_render_instance_t :
-    public transformer_render_instance_t<view_2d_transformer_t>
+    public fusable_render_instance_t<view_2d_transformer_t>
 {
   public:
-    using transformer_render_instance_t::transformer_render_instance_t;
+    using fusable_render_instance_t::fusable_render_instance_t;
 
     void transform_damage_region(wf::region_t& damage) override
     {
         transform_linear_damage(self.get(), damage);
     }
 
+    glm::mat4 get_transform_matrix() override
+    {
+        return get_2d_transform_matrix(self.get());
+    }
+
+    glm::vec4 get_color() override
+    {
+        return glm::vec4{1.0, 1.0, 1.0, self->get_alpha()};
+    }
+
+    bool is_axis_aligned() override
+    {
+        return std::abs(self->get_angle()) < 1e-3;
+    }
+
     void render(const wf::scene::render_instruction_t& data) override
     {
-        if (std::abs(self->get_angle()) < 1e-3)
+        if (render_fused(data))
+        {
+            return;
+        }
+
+        if (is_axis_aligned())
         {
             // No rotation, we can use render-agnostic functions.
             auto tex = this->get_texture(data.target.scale);
@@ -212,20 +424,9 @@ class view_2d_render_instance_t :
         }
 
         // Untransformed bounding box
-        auto bbox = self->get_children_bounding_box();
-
-        auto midpoint  = get_center(self->view);
-        auto center_at = glm::translate(glm::mat4(1.0),
-            {-midpoint.x, -midpoint.y, 0.0});
-        auto scale = glm::scale(glm::mat4(1.0),
-            glm::vec3{self->get_scale_x(), self->get_scale_y(), 1.0});
-        auto rotate = glm::rotate<float>(glm::mat4(1.0), -self->get_angle(),
-            glm::vec3{0.0, 0.0, 1.0});
-        auto translate = glm::translate(glm::mat4(1.0),
-            glm::vec3{self->get_translation_x() + midpoint.x,
-                self->get_translation_y() + midpoint.y, 0.0});
+        auto bbox  = self->get_children_bounding_box();
         auto ortho = wf::gles::render_target_orthographic_projection(data.target);
-        auto full_matrix = ortho * translate * rotate * scale * center_at;
+        auto full_matrix = ortho * get_2d_transform_matrix(self.get());
 
         data.pass->custom_gles_subpass([&]
         {
@@ -341,10 +542,15 @@ wf::pointf_t view_3d_transformer_t::to_local(const wf::pointf_t& point)
 
 wf::pointf_t view_3d_transformer_t::to_global(const wf::pointf_t& point)
 {
-    auto wm_geom = get_children_bounding_box();
+    return apply_3d_transform(get_children_bounding_box(), calculate_total_transform(), point);
+}
+
+wf::pointf_t apply_3d_transform(wf::geometry_t wm_geom, const glm::mat4& total_transform,
+    const wf::pointf_t& point)
+{
     auto p = get_center_relative_coords(wm_geom, point);
     glm::vec4 v(1.0f * p.x, 1.0f * p.y, 0, 1);
-    v = calculate_total_transform() * v;
+    v = total_transform * v;
 
     if (std::abs(v.w) < 1e-6)
     {
@@ -409,10 +615,10 @@ static transformable_quad center_geometry(wf::geometry_t output_geometry,
 }
 
 class view_3d_render_instance_t :
-    public transformer_render_instance_t<view_3d_transformer_t>
+    public fusable_render_instance_t<view_3d_transformer_t>
 {
   public:
-    using transformer_render_instance_t::transformer_render_instance_t;
+    using fusable_render_instance_t::fusable_render_instance_t;
 
 
     void transform_damage_region(wf::region_t& damage) override
@@ -420,8 +626,28 @@ class view_3d_render_instance_t :
         transform_linear_damage(self.get(), damage);
     }
 
+    glm::mat4 get_transform_matrix() override
+    {
+        return get_3d_transform_matrix(self->get_children_bounding_box(), self->calculate_total_transform());
+    }
+
+    glm::vec4 get_color() override
+    {
+        return self->color;
+    }
+
+    bool is_axis_aligned() override
+    {
+        return false;
+    }
+
     void render(const wf::scene::render_instruction_t& data) override
     {
+        if (render_fused(data))
+        {
+            return;
+        }
+
         auto bbox = self->get_children_bounding_box();
         auto quad = center_geometry(data.target.geometry, bbox, scene::get_center(bbox));
 
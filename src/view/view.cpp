@@ -165,6 +165,12 @@ class view_root_node_t : public wf::scene::floating_inner_node_t, public wf::vie
         }
     }
 
+    bool has_bounded_input() override
+    {
+        // The bounding box of a view includes all of its surfaces, popups, decorations, etc.
+        return true;
+    }
+
   private:
     std::weak_ptr<wf::view_interface_t> view;
 };
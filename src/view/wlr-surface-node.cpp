@@ -7,13 +7,75 @@
 #include "wlr-surface-pointer-interaction.hpp"
 #include "wlr-surface-touch-interaction.cpp"
 #include "wayfire/output-layout.hpp"
+#include "wayfire/matcher.hpp"
+#include "wayfire/view.hpp"
 #include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
 #include <memory>
 #include <sstream>
 #include <string>
 #include <wayfire/signal-provider.hpp>
 #include <wlr/util/box.h>
 
+namespace
+{
+/**
+ * Decides which surfaces get their frame callbacks at a reduced rate while they are not visible on any
+ * output, for example because they are covered by other windows or are on another workspace.
+ */
+class frame_throttle_policy_t
+{
+    wf::option_wrapper_t<int> hidden_frame_interval{"workarounds/hidden_surface_frame_interval"};
+    wf::view_matcher_t exempt_views{"workarounds/hidden_surface_throttle_exempt"};
+
+  public:
+    static frame_throttle_policy_t& get()
+    {
+        static frame_throttle_policy_t policy;
+        return policy;
+    }
+
+    /** @return The interval between frame callbacks of hidden surfaces in milliseconds. */
+    int get_interval() const
+    {
+        return hidden_frame_interval;
+    }
+
+    /** @return Whether hidden surfaces are throttled at all. */
+    bool is_enabled() const
+    {
+        return hidden_frame_interval > 0;
+    }
+
+    /** @return Whether the surface may receive throttled frame callbacks while it is hidden. */
+    bool may_throttle(wlr_surface *surface)
+    {
+        if (!surface || !is_enabled())
+        {
+            return false;
+        }
+
+        return !is_exempt(surface);
+    }
+
+    /**
+     * @return Whether the surface keeps receiving frame callbacks at the output's rate while it is hidden.
+     * When throttling is disabled, hidden surfaces receive no frame callbacks at all.
+     */
+    bool is_exempt(wlr_surface *surface)
+    {
+        if (!surface || !is_enabled())
+        {
+            return false;
+        }
+
+        // Surfaces which do not belong to a view (cursors, drag icons, etc.) are never exempt.
+        auto view = wf::wl_surface_to_wayfire_view(wlr_surface_get_root_surface(surface)->resource);
+        return view && exempt_views.matches(view);
+    }
+};
+}
+
 wf::scene::surface_state_t::surface_state_t(surface_state_t&& other)
 {
     if (&other != this)
@@ -111,18 +173,50 @@ wf::scene::wlr_surface_node_t::wlr_surface_node_t(wlr_surface *surface, bool aut
 
         on_surface_commit.disconnect();
         on_surface_destroyed.disconnect();
+        hidden_frame_timer.disconnect();
     });
 
     this->on_surface_commit.set_callback([=] (void*)
     {
+        // A resize may uncover or hide other parts of the scene, so it is always considered visible.
+        wf::region_t damage;
+        wlr_surface_get_effective_damage(surface, damage.to_pixman());
+        const bool resized = current_state.size !=
+            wf::dimensions_t{surface->current.width, surface->current.height};
+
         if (this->autocommit)
         {
             apply_current_surface_state();
         }
 
+        std::vector<wf::output_t*> hidden_on;
         for (auto& [wo, _] : visibility)
         {
-            wo->render->schedule_redraw();
+            if (resized || is_commit_visible(wo, damage))
+            {
+                wo->render->schedule_redraw();
+            } else
+            {
+                hidden_on.push_back(wo);
+            }
+        }
+
+        if (hidden_on.empty())
+        {
+            return;
+        }
+
+        if (frame_throttle_policy_t::get().may_throttle(surface))
+        {
+            // Nothing visible changed, so there is no need to repaint. The client still expects frame
+            // callbacks, which we send at a reduced rate.
+            schedule_hidden_frame_done();
+        } else
+        {
+            for (auto wo : hidden_on)
+            {
+                wo->render->schedule_redraw();
+            }
         }
     });
 
@@ -235,6 +329,17 @@ void wf::scene::wlr_surface_node_t::send_frame_done(bool delay_until_vblank)
     }
 }
 
+void wf::scene::wlr_surface_node_t::schedule_hidden_frame_done()
+{
+    if (!hidden_frame_timer.is_connected())
+    {
+        hidden_frame_timer.set_timeout(frame_throttle_policy_t::get().get_interval(), [=] ()
+        {
+            send_frame_done(false);
+        });
+    }
+}
+
 class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public render_instance_t
 {
     std::shared_ptr<wlr_surface_node_t> self;
@@ -246,9 +351,11 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
     wf::output_t *visible_on;
     damage_callback push_damage;
     wf::region_t last_visibility;
+    // Whether last_visibility has been computed. Instances which are rendered by plugins outside of the
+    // output's scenegraph may never get compute_visibility() calls.
+    bool visibility_known = false;
 
-    wf::signal::connection_t<node_damage_signal> on_surface_damage =
-        [=] (node_damage_signal *data)
+    void expand_scaled_damage(wf::region_t& damage)
     {
         if (self->surface)
         {
@@ -257,21 +364,20 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
             const float output_scale = visible_on ? visible_on->handle->scale : 1.0;
             if (scale != output_scale)
             {
-                data->region.expand_edges(std::ceil(std::abs(scale - output_scale)));
+                damage.expand_edges(std::ceil(std::abs(scale - output_scale)));
             }
         }
+    }
 
-        static wf::option_wrapper_t<bool> use_opaque_optimizations{
-            "workarounds/enable_opaque_region_damage_optimizations"
-        };
+    wf::signal::connection_t<node_damage_signal> on_surface_damage =
+        [=] (node_damage_signal *data)
+    {
+        expand_scaled_damage(data->region);
 
-        if (use_opaque_optimizations)
-        {
-            push_damage(data->region & last_visibility);
-        } else
-        {
-            push_damage(data->region);
-        }
+        // Damage outside of the output does not need a repaint, and neither does damage covered by opaque
+        // surfaces if the opaque region optimizations are enabled, see compute_visibility().
+        // Until the visibility is known, last_visibility covers everything.
+        push_damage(data->region & last_visibility);
     };
 
   public:
@@ -287,6 +393,7 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
         this->push_damage = push_damage;
         this->visible_on  = visible_on;
         self->connect(&on_surface_damage);
+        self->live_instances.push_back(this);
         this->last_visibility |= wlr_box{INT_MIN / 2, INT_MIN / 2, INT_MAX, INT_MAX};
     }
 
@@ -296,6 +403,42 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
         {
             self->handle_leave(visible_on);
         }
+
+        auto& live = self->live_instances;
+        live.erase(std::remove(live.begin(), live.end(), this), live.end());
+    }
+
+    wf::output_t *get_output() const
+    {
+        return visible_on;
+    }
+
+    /** @return Whether any part of the surface may be visible through this instance. */
+    bool may_be_visible() const
+    {
+        return !visibility_known || !(last_visibility & self->get_bounding_box()).empty();
+    }
+
+    /**
+     * Check whether a commit with the given damage (in surface-local coordinates) changes anything that
+     * is visible through this instance. A commit without damage is considered visible if any part of
+     * the surface is visible, because the client is likely waiting for a frame callback.
+     */
+    bool is_commit_visible(wf::region_t damage)
+    {
+        if (!visibility_known)
+        {
+            return true;
+        }
+
+        const wf::region_t visible = last_visibility & self->get_bounding_box();
+        if (visible.empty())
+        {
+            return false;
+        }
+
+        expand_scaled_damage(damage);
+        return damage.empty() || !(damage & visible).empty();
     }
 
     void schedule_instructions(std::vector<render_instruction_t>& instructions,
@@ -389,7 +532,8 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
         // Note that we store the visibility before clipping to our bounding box, because damage
         // may be outside of it (e.g., if the surface resizes to a larger size and the visibility is not
         // immediately recomputed due to optimizations).
-        last_visibility = visible;
+        last_visibility  = visible;
+        visibility_known = true;
 
         static wf::option_wrapper_t<bool> use_opaque_optimizations{
             "workarounds/enable_opaque_region_damage_optimizations"
@@ -405,6 +549,15 @@ class wf::scene::wlr_surface_node_t::wlr_surface_render_instance_t : public rend
                 pixman_region32_subtract(visible.to_pixman(), visible.to_pixman(),
                     &self->surface->opaque_region);
             }
+        } else if (frame_throttle_policy_t::get().is_exempt(self->surface))
+        {
+            // Hidden, but exempt from throttling => keep sending frame callbacks at the output's rate.
+            output->connect(&on_frame_done);
+        } else if (self->surface && !wl_list_empty(&self->surface->current.frame_callback_list) &&
+                   self->is_throttled())
+        {
+            // The surface became hidden while the client waits for a frame callback.
+            self->schedule_hidden_frame_done();
         }
     }
 };
@@ -417,6 +570,38 @@ void wf::scene::wlr_surface_node_t::gen_render_instances(
         std::dynamic_pointer_cast<wlr_surface_node_t>(this->shared_from_this()), damage, output));
 }
 
+bool wf::scene::wlr_surface_node_t::is_commit_visible(wf::output_t *output, const wf::region_t& damage)
+{
+    bool found = false;
+    for (auto instance : live_instances)
+    {
+        if (instance->get_output() == output)
+        {
+            found = true;
+            if (instance->is_commit_visible(damage))
+            {
+                return true;
+            }
+        }
+    }
+
+    // Without a render instance on the output, we cannot know, so assume the commit is visible.
+    return !found;
+}
+
+bool wf::scene::wlr_surface_node_t::is_throttled()
+{
+    if (live_instances.empty() || !frame_throttle_policy_t::get().may_throttle(surface))
+    {
+        return false;
+    }
+
+    return std::none_of(live_instances.begin(), live_instances.end(), [] (auto instance)
+    {
+        return instance->may_be_visible();
+    });
+}
+
 wf::geometry_t wf::scene::wlr_surface_node_t::get_bounding_box()
 {
     return wf::construct_box({0, 0}, current_state.size);
@@ -0,0 +1,210 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "particle-arrays.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+
+/*
+ * The previous implementation of the particle update, with an array of
+ * particle structs whose fields were copied to the vertex arrays after each
+ * update, used as a reference.
+ */
+namespace reference
+{
+struct particle_system_t
+{
+    std::vector<Particle> ps;
+    std::vector<float> color, dark_color, radius, center;
+    int alive = 0;
+
+    void resize(int num)
+    {
+        ps.resize(num);
+        color.resize(4 * num);
+        dark_color.resize(4 * num);
+        radius.resize(num);
+        center.resize(2 * num);
+    }
+
+    int spawn(int num, const ParticleIniter& init)
+    {
+        int spawned = 0;
+        for (size_t i = 0; i < ps.size() && spawned < num; i++)
+        {
+            if (ps[i].life <= 0)
+            {
+                init(ps[i]);
+                ++spawned;
+                ++alive;
+            }
+        }
+
+        return spawned;
+    }
+
+    static void update_particle(Particle& p)
+    {
+        const float slowdown = 0.8;
+        p.pos   += p.speed * 0.2f * slowdown;
+        p.speed += p.g * 0.3f * slowdown;
+        if (p.life != 0)
+        {
+            p.color.a /= p.life;
+        }
+
+        p.life    -= p.fade * 0.3 * slowdown;
+        p.radius   = p.base_radius * std::pow(p.life, 0.5);
+        p.color.a *= p.life;
+        p.g.x = (p.start_pos.x < p.pos.x) ? -1 : 1;
+        if (p.life <= 0)
+        {
+            p.pos = {-10000, -10000};
+        }
+    }
+
+    void update()
+    {
+        for (size_t i = 0; i < ps.size(); i++)
+        {
+            if (ps[i].life <= 0)
+            {
+                continue;
+            }
+
+            update_particle(ps[i]);
+            if (ps[i].life <= 0)
+            {
+                --alive;
+            }
+
+            for (int j = 0; j < 4; j++)
+            {
+                color[4 * i + j] = ps[i].color[j];
+                dark_color[4 * i + j] = ps[i].color[j] * 0.5;
+            }
+
+            center[2 * i]     = ps[i].pos[0];
+            center[2 * i + 1] = ps[i].pos[1];
+            radius[i] = ps[i].radius;
+        }
+    }
+};
+}
+
+/* An initer similar to the one of the fire animation, but deterministic. */
+static ParticleIniter make_initer(int seed)
+{
+    auto gen = std::make_shared<std::mt19937>(seed);
+    return [gen] (Particle& p)
+    {
+        auto random = [&] (float s, float e) { return std::uniform_real_distribution<float>(s, e)(*gen); };
+        p.life  = 1;
+        p.fade  = random(0.1, 0.6);
+        p.color = {random(0, 1), random(0, 1), random(0, 1), 1};
+        p.pos   = {random(0, 1000), random(290, 310)};
+        p.start_pos = p.pos;
+        p.speed     = {random(-10, 10), random(-25, 5)};
+        p.g = {-1, -3};
+        p.base_radius = p.radius = random(13, 19);
+    };
+}
+
+TEST_CASE("Particle arrays are equivalent to the reference implementation")
+{
+    const int count = 5000;
+    reference::particle_system_t ref;
+    ParticleArrays soa;
+    ref.resize(count);
+    soa.resize(count);
+
+    auto ref_init = make_initer(7);
+    auto soa_init = make_initer(7);
+    for (int frame = 0; frame < 100; frame++)
+    {
+        REQUIRE(ref.spawn(count / 10, ref_init) == soa.spawn(count / 10, soa_init));
+        ref.update();
+        soa.update();
+        REQUIRE(ref.alive == soa.alive());
+
+        for (int i = 0; i < count; i++)
+        {
+            if (ref.ps[i].life <= 0)
+            {
+                continue;
+            }
+
+            CHECK(soa.life[i] == doctest::Approx(ref.ps[i].life).epsilon(1e-4));
+            CHECK(soa.center[2 * i] == doctest::Approx(ref.center[2 * i]).epsilon(1e-4));
+            CHECK(soa.center[2 * i + 1] == doctest::Approx(ref.center[2 * i + 1]).epsilon(1e-4));
+            CHECK(soa.radius[i] == doctest::Approx(ref.radius[i]).epsilon(1e-4));
+            CHECK(soa.color[4 * i + 3] == doctest::Approx(ref.color[4 * i + 3]).epsilon(1e-4));
+        }
+    }
+}
+
+/*
+ * Measures the time to update the particles and to copy their vertex
+ * attributes to a buffer, like glBufferData() would.
+ */
+TEST_CASE("Benchmark particle update and upload")
+{
+    std::vector<float> gpu_buffer;
+    auto upload = [&] (const std::vector<float>& data)
+    {
+        gpu_buffer.resize(data.size());
+        std::memcpy(gpu_buffer.data(), data.data(), data.size() * sizeof(float));
+    };
+
+    for (int count : {1000, 10000, 50000, 200000})
+    {
+        const int frames = std::max(20, 20'000'000 / count);
+        reference::particle_system_t ref;
+        ParticleArrays soa;
+        ref.resize(count);
+        soa.resize(count);
+
+        auto ref_init = make_initer(count);
+        auto soa_init = make_initer(count);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            ref.spawn(count / 10, ref_init);
+            ref.update();
+            upload(ref.center);
+            upload(ref.radius);
+            upload(ref.dark_color);
+            upload(ref.color);
+        }
+
+        auto ref_time = std::chrono::steady_clock::now() - start;
+
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            soa.spawn(count / 10, soa_init);
+            soa.update();
+            upload(soa.center);
+            upload(soa.radius);
+            upload(soa.color);
+        }
+
+        auto soa_time = std::chrono::steady_clock::now() - start;
+        CHECK(ref.alive == soa.alive());
+
+        auto per_frame = [&] (auto duration)
+        {
+            return std::chrono::duration<double, std::micro>(duration).count() / frames;
+        };
+
+        std::cout << count << " particles: " << per_frame(soa_time) << " us/frame structure of arrays, " <<
+            per_frame(ref_time) << " us/frame previous implementation" << std::endl;
+    }
+}
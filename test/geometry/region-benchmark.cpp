@@ -0,0 +1,243 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+#include <wayfire/region.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <iterator>
+#include <random>
+
+/* Check that the region is the same as the result of the given pixman operation */
+template<class Op>
+static void check_same(const wf::region_t& result, Op op)
+{
+    pixman_region32_t expected;
+    pixman_region32_init(&expected);
+    op(&expected);
+    CHECK(pixman_region32_equal(const_cast<pixman_region32_t*>(result.to_pixman()), &expected));
+    pixman_region32_fini(&expected);
+}
+
+TEST_CASE("Region operations match pixman")
+{
+    std::mt19937 gen(17);
+    std::uniform_int_distribution<int> coord(0, 12), size(1, 8), region_kind(0, 2), count(2, 4);
+
+    auto random_box = [&] () -> wlr_box
+    {
+        return {coord(gen), coord(gen), size(gen), size(gen)};
+    };
+
+    /* An empty region, a single box or a union of a few boxes */
+    auto random_region = [&] ()
+    {
+        wf::region_t region;
+        switch (region_kind(gen))
+        {
+          case 0:
+            break;
+
+          case 1:
+            region = wf::region_t{random_box()};
+            break;
+
+          default:
+            for (int i = count(gen); i > 0; i--)
+            {
+                wlr_box box = random_box();
+                pixman_region32_union_rect(region.to_pixman(), region.to_pixman(),
+                    box.x, box.y, box.width, box.height);
+            }
+        }
+
+        return region;
+    };
+
+    for (int i = 0; i < 20000; i++)
+    {
+        wf::region_t a = random_region();
+        wf::region_t b = random_region();
+        wlr_box box    = random_box();
+        auto pa = a.to_pixman();
+        auto pb = b.to_pixman();
+
+        check_same(a & b, [&] (auto r) { pixman_region32_intersect(r, pa, pb); });
+        check_same(a | b, [&] (auto r) { pixman_region32_union(r, pa, pb); });
+        check_same(a ^ b, [&] (auto r) { pixman_region32_subtract(r, pa, pb); });
+        check_same(a & box, [&] (auto r)
+        {
+            pixman_region32_intersect_rect(r, pa, box.x, box.y, box.width, box.height);
+        });
+        check_same(a | box, [&] (auto r)
+        {
+            pixman_region32_union_rect(r, pa, box.x, box.y, box.width, box.height);
+        });
+        check_same(a ^ box, [&] (auto r)
+        {
+            wf::region_t sub{box};
+            pixman_region32_subtract(r, pa, sub.to_pixman());
+        });
+        check_same(a + wf::point_t{3, -5}, [&] (auto r)
+        {
+            pixman_region32_copy(r, pa);
+            pixman_region32_translate(r, 3, -5);
+        });
+
+        wf::region_t c = a;
+        c &= b;
+        check_same(c, [&] (auto r) { pixman_region32_intersect(r, pa, pb); });
+        c = a;
+        c |= b;
+        check_same(c, [&] (auto r) { pixman_region32_union(r, pa, pb); });
+        c = a;
+        c ^= b;
+        check_same(c, [&] (auto r) { pixman_region32_subtract(r, pa, pb); });
+        CHECK(a.empty() == !pixman_region32_not_empty(pa));
+    }
+}
+
+static int count_boxes(const wf::region_t& region)
+{
+    return std::distance(region.begin(), region.end());
+}
+
+static int64_t region_area(const wf::region_t& region)
+{
+    int64_t area = 0;
+    for (auto& box : region)
+    {
+        area += int64_t(box.x2 - box.x1) * (box.y2 - box.y1);
+    }
+
+    return area;
+}
+
+TEST_CASE("Region simplification")
+{
+    SUBCASE("Simple regions are not changed")
+    {
+        wf::region_t region{wlr_box{10, 10, 100, 100}};
+        CHECK(count_boxes(wf::simplify_region(region, 4, 0.25)) == 1);
+        CHECK(wf::simplify_region(wf::region_t{}, 4, 0.25).empty());
+    }
+
+    SUBCASE("Nearly full regions are replaced by their extents")
+    {
+        wf::region_t region{wlr_box{0, 0, 100, 100}};
+        region ^= wlr_box{50, 50, 10, 10};
+        auto simplified = wf::simplify_region(region, 32, 0.25);
+        CHECK(count_boxes(simplified) == 1);
+        CHECK(simplified.get_extents().x2 == 100);
+
+        /* Not if the extents are much bigger than the region */
+        wf::region_t sparse = wf::region_t{wlr_box{0, 0, 10, 10}} | wlr_box{90, 90, 10, 10};
+        CHECK(count_boxes(wf::simplify_region(sparse, 32, 0.25)) == 2);
+    }
+
+    SUBCASE("Fragmented regions are merged")
+    {
+        /* Blinking cursors in many terminals all over the screen */
+        std::mt19937 gen(3);
+        std::uniform_int_distribution<int> x(0, 1900), y(0, 1060);
+        wf::region_t region;
+        for (int i = 0; i < 300; i++)
+        {
+            region |= wlr_box{x(gen), y(gen), 2, 18};
+        }
+
+        for (int max_boxes : {1, 4, 16, 32, 64})
+        {
+            auto simplified = wf::simplify_region(region, max_boxes, 0.25);
+            CHECK((region ^ simplified).empty());
+            CHECK(count_boxes(simplified) <= max_boxes);
+            std::cout << "Fragmented damage, max " << max_boxes << " boxes: " << count_boxes(region) <<
+                " boxes before, " << count_boxes(simplified) << " after, area " << region_area(region) <<
+                " before, " << region_area(simplified) << " after" << std::endl;
+        }
+
+        CHECK(count_boxes(wf::simplify_region(region, 0, 0.25)) == count_boxes(region));
+    }
+}
+
+/* A region consisting of count x count disjoint boxes */
+static wf::region_t make_grid_region(int count, int offset)
+{
+    wf::region_t region;
+    for (int i = 0; i < count; i++)
+    {
+        for (int j = 0; j < count; j++)
+        {
+            region |= wlr_box{offset + i * 200, offset + j * 200, 150, 150};
+        }
+    }
+
+    return region;
+}
+
+/*
+ * Measures the throughput of the region operations, compared to calling
+ * pixman directly, which is what wf::region_t used to do.
+ */
+TEST_CASE("Benchmark region operations")
+{
+    const int iterations = 200000;
+    for (int count : {1, 2, 8})
+    {
+        const int boxes = count * count;
+        const wf::region_t a = make_grid_region(count, 0);
+        const wf::region_t b = make_grid_region(count, 50);
+        const wlr_box clip   = {0, 0, count * 200, count * 200};
+        auto pa = const_cast<pixman_region32_t*>(a.to_pixman());
+        auto pb = const_cast<pixman_region32_t*>(b.to_pixman());
+        REQUIRE(std::distance(a.begin(), a.end()) == boxes);
+
+        auto measure = [&] (auto op)
+        {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < iterations; i++)
+            {
+                op();
+            }
+
+            auto duration = std::chrono::steady_clock::now() - start;
+            return 1.0 * iterations / std::chrono::duration<double>(duration).count() / 1e6;
+        };
+
+        size_t sink = 0;
+        double intersect = measure([&] { sink += (a & b).empty(); });
+        double intersect_box = measure([&] { sink += (a & clip).empty(); });
+        double unite     = measure([&] { sink += (a | b).empty(); });
+        double translate = measure([&] { sink += (a + wf::point_t{10, 10}).empty(); });
+
+        auto pixman_op = [&] (auto op)
+        {
+            return measure([&]
+            {
+                pixman_region32_t r;
+                pixman_region32_init(&r);
+                op(&r);
+                sink += !pixman_region32_not_empty(&r);
+                pixman_region32_fini(&r);
+            });
+        };
+
+        double pixman_intersect = pixman_op([&] (auto r) { pixman_region32_intersect(r, pa, pb); });
+        double pixman_intersect_box = pixman_op([&] (auto r)
+        {
+            pixman_region32_intersect_rect(r, pa, clip.x, clip.y, clip.width, clip.height);
+        });
+        double pixman_unite = pixman_op([&] (auto r) { pixman_region32_union(r, pa, pb); });
+        double pixman_translate = pixman_op([&] (auto r)
+        {
+            pixman_region32_copy(r, pa);
+            pixman_region32_translate(r, 10, 10);
+        });
+
+        std::cout << boxes << " boxes (Mops/s, region_t vs pixman): " <<
+            "intersect " << intersect << " vs " << pixman_intersect << ", " <<
+            "intersect box " << intersect_box << " vs " << pixman_intersect_box << ", " <<
+            "union " << unite << " vs " << pixman_unite << ", " <<
+            "translate " << translate << " vs " << pixman_translate <<
+            " (" << sink << ")" << std::endl;
+    }
+}
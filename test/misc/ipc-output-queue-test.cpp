@@ -0,0 +1,63 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "ipc-output-queue.hpp"
+#include <vector>
+
+static std::deque<wf::ipc::queued_message_t> make_queue(int count)
+{
+    std::deque<wf::ipc::queued_message_t> queue;
+    for (int i = 0; i < count; i++)
+    {
+        auto payload = std::make_shared<const std::string>("{\"event\": " + std::to_string(i) + "}");
+        queue.push_back({(uint32_t)payload->size(), payload});
+    }
+
+    return queue;
+}
+
+TEST_CASE("Output iovecs start at the write offset")
+{
+    auto queue = make_queue(3);
+    iovec iov[8];
+
+    size_t n = wf::ipc::fill_output_iov(queue, 0, iov, 8);
+    REQUIRE(n == 6);
+    REQUIRE(iov[0].iov_base == &queue[0].header);
+    REQUIRE(iov[1].iov_base == queue[0].payload->data());
+
+    // Half of the header was written
+    n = wf::ipc::fill_output_iov(queue, 2, iov, 8);
+    REQUIRE(n == 6);
+    REQUIRE(iov[0].iov_base == (char*)&queue[0].header + 2);
+    REQUIRE(iov[0].iov_len == 2);
+
+    // The header and a part of the payload were written
+    n = wf::ipc::fill_output_iov(queue, sizeof(uint32_t) + 3, iov, 8);
+    REQUIRE(n == 5);
+    REQUIRE(iov[0].iov_base == queue[0].payload->data() + 3);
+    REQUIRE(iov[0].iov_len == queue[0].payload->size() - 3);
+    REQUIRE(iov[1].iov_base == &queue[1].header);
+}
+
+TEST_CASE("Output iovecs never exceed the array")
+{
+    constexpr size_t MAX_IOV = 64;
+    auto queue = make_queue(200);
+
+    // Guard entries after the array to detect overflows
+    std::vector<iovec> iov(2 * MAX_IOV + 2, iovec{nullptr, 0});
+    for (size_t offset : {(size_t)0, (size_t)1, sizeof(uint32_t), sizeof(uint32_t) + 1})
+    {
+        const size_t n = wf::ipc::fill_output_iov(queue, offset, iov.data(), 2 * MAX_IOV);
+        REQUIRE(n <= 2 * MAX_IOV);
+        REQUIRE(n >= 2 * MAX_IOV - 1);
+        REQUIRE(iov[2 * MAX_IOV].iov_base == nullptr);
+        REQUIRE(iov[2 * MAX_IOV + 1].iov_base == nullptr);
+
+        // Only the first message may be cut, the last entry is a whole payload
+        const size_t last = (offset < sizeof(uint32_t)) ? (n / 2 - 1) : ((n - 1) / 2);
+        REQUIRE(iov[n - 1].iov_base == queue[last].payload->data());
+        REQUIRE(iov[n - 1].iov_len == queue[last].payload->size());
+    }
+}
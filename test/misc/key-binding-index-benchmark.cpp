@@ -0,0 +1,216 @@
+#include "core/seat/key-binding-index.hpp"
+#include <wayfire/config/types.hpp>
+#include <wayfire/config/option.hpp>
+#include <linux/input-event-codes.h>
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+static const uint32_t modifiers[] = {
+    0, WLR_MODIFIER_LOGO, WLR_MODIFIER_ALT, WLR_MODIFIER_CTRL,
+    WLR_MODIFIER_LOGO | WLR_MODIFIER_SHIFT, WLR_MODIFIER_CTRL | WLR_MODIFIER_ALT,
+};
+
+struct bindings_t
+{
+    wf::key_binding_index_t::keys_t keys;
+    wf::key_binding_index_t::activators_t activators;
+
+    // Owns the callbacks, bindings only store pointers to them
+    std::vector<std::unique_ptr<wf::key_callback>> key_callbacks;
+    std::vector<std::unique_ptr<wf::activator_callback>> activator_callbacks;
+    int triggered = 0;
+};
+
+static wf::keybinding_t random_key(std::mt19937& gen)
+{
+    std::uniform_int_distribution<size_t> mod(0, std::size(modifiers) - 1);
+    std::uniform_int_distribution<uint32_t> key(KEY_ESC, KEY_F12);
+    return wf::keybinding_t{modifiers[mod(gen)], key(gen)};
+}
+
+static void make_bindings(bindings_t& bindings, int count, std::mt19937& gen)
+{
+    for (int i = 0; i < count; i++)
+    {
+        if (i % 2 == 0)
+        {
+            auto binding = std::make_unique<wf::binding_t<wf::keybinding_t, wf::key_callback>>();
+            binding->activated_by = wf::create_option(random_key(gen));
+            bindings.key_callbacks.push_back(std::make_unique<wf::key_callback>(
+                [&bindings] (const wf::keybinding_t&) { ++bindings.triggered; return false; }));
+            binding->callback = bindings.key_callbacks.back().get();
+            bindings.keys.push_back(std::move(binding));
+        } else
+        {
+            // Activators with two key combinations and a button, like a typical command binding
+            auto str = wf::option_type::to_string(random_key(gen)) + " | " +
+                wf::option_type::to_string(random_key(gen)) + " | <super> BTN_LEFT";
+            auto value = wf::option_type::from_string<wf::activatorbinding_t>(str);
+            REQUIRE(value.has_value());
+
+            auto binding = std::make_unique<wf::binding_t<wf::activatorbinding_t, wf::activator_callback>>();
+            binding->activated_by = wf::create_option(*value);
+            bindings.activator_callbacks.push_back(std::make_unique<wf::activator_callback>(
+                [&bindings] (const wf::activator_data_t&) { ++bindings.triggered; return false; }));
+            binding->callback = bindings.activator_callbacks.back().get();
+            bindings.activators.push_back(std::move(binding));
+        }
+    }
+}
+
+/**
+ * The bindings matching a key combination as found by a linear search over all bindings.
+ */
+static std::vector<void*> find_reference(const bindings_t& bindings, const wf::keybinding_t& pressed)
+{
+    std::vector<void*> result;
+    for (auto& binding : bindings.keys)
+    {
+        if (binding->activated_by->get_value() == pressed)
+        {
+            result.push_back(binding->callback);
+        }
+    }
+
+    for (auto& binding : bindings.activators)
+    {
+        if (binding->activated_by->get_value().has_match(pressed))
+        {
+            result.push_back(binding->callback);
+        }
+    }
+
+    return result;
+}
+
+static std::vector<void*> find_indexed(const wf::key_binding_index_t& index, const wf::keybinding_t& pressed)
+{
+    std::vector<void*> result;
+    if (auto matches = index.find(pressed))
+    {
+        for (auto& entry : *matches)
+        {
+            result.push_back(entry.key ? (void*)entry.key : (void*)entry.activator);
+        }
+    }
+
+    return result;
+}
+
+TEST_CASE("Indexed key binding lookup matches linear search")
+{
+    std::mt19937 gen(42);
+    for (int count : {0, 1, 10, 500})
+    {
+        bindings_t bindings;
+        make_bindings(bindings, count, gen);
+        wf::key_binding_index_t index{bindings.keys, bindings.activators};
+
+        for (int i = 0; i < 10000; i++)
+        {
+            auto pressed = random_key(gen);
+            REQUIRE(find_indexed(index, pressed) == find_reference(bindings, pressed));
+        }
+
+        // Modifier bindings and keys which are bound multiple times
+        for (auto& binding : bindings.keys)
+        {
+            auto pressed = binding->activated_by->get_value();
+            REQUIRE(find_indexed(index, pressed) == find_reference(bindings, pressed));
+        }
+    }
+}
+
+TEST_CASE("Activators listing the same key twice are triggered once")
+{
+    auto value = wf::option_type::from_string<wf::activatorbinding_t>("<super> KEY_A | <super> KEY_A");
+    REQUIRE(value.has_value());
+
+    wf::activator_callback callback = [] (const wf::activator_data_t&) { return true; };
+    bindings_t bindings;
+    auto binding = std::make_unique<wf::binding_t<wf::activatorbinding_t, wf::activator_callback>>();
+    binding->activated_by = wf::create_option(*value);
+    binding->callback     = &callback;
+    bindings.activators.push_back(std::move(binding));
+
+    wf::key_binding_index_t index{bindings.keys, bindings.activators};
+    auto matches = index.find(wf::keybinding_t{WLR_MODIFIER_LOGO, KEY_A});
+    REQUIRE(matches != nullptr);
+    REQUIRE(matches->size() == 1);
+    REQUIRE(index.find(wf::keybinding_t{0, KEY_A}) == nullptr);
+}
+
+TEST_CASE("Benchmark key binding dispatch")
+{
+    std::mt19937 gen(1234);
+    bindings_t bindings;
+    make_bindings(bindings, 500, gen);
+
+    std::vector<wf::keybinding_t> presses;
+    for (int i = 0; i < 200000; i++)
+    {
+        presses.push_back(random_key(gen));
+    }
+
+    // Dispatch as done before the index: collect the matching callbacks in a vector, then call them
+    bindings.triggered = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (auto& pressed : presses)
+    {
+        std::vector<std::function<bool()>> callbacks;
+        for (auto& binding : bindings.keys)
+        {
+            if (binding->activated_by->get_value() == pressed)
+            {
+                auto callback = binding->callback;
+                callbacks.emplace_back([pressed, callback] () { return (*callback)(pressed); });
+            }
+        }
+
+        for (auto& binding : bindings.activators)
+        {
+            if (binding->activated_by->get_value().has_match(pressed))
+            {
+                auto callback = binding->callback;
+                callbacks.emplace_back([callback] () { return (*callback)(wf::activator_data_t{}); });
+            }
+        }
+
+        for (auto& cb : callbacks)
+        {
+            cb();
+        }
+    }
+
+    auto linear = std::chrono::steady_clock::now() - start;
+    const int linear_triggered = bindings.triggered;
+
+    bindings.triggered = 0;
+    start = std::chrono::steady_clock::now();
+    wf::key_binding_index_t index{bindings.keys, bindings.activators};
+    for (auto& pressed : presses)
+    {
+        if (auto matches = index.find(pressed))
+        {
+            for (auto& entry : *matches)
+            {
+                entry.key ? (*entry.key)(pressed) : (*entry.activator)(wf::activator_data_t{});
+            }
+        }
+    }
+
+    auto indexed = std::chrono::steady_clock::now() - start;
+    REQUIRE(bindings.triggered == linear_triggered);
+
+    auto per_sec = [&] (auto duration)
+    {
+        return (uint64_t)(presses.size() / std::chrono::duration<double>(duration).count());
+    };
+
+    std::cout << "500 bindings: " << per_sec(indexed) << " key presses/s indexed, " <<
+        per_sec(linear) << " key presses/s linear" << std::endl;
+}
@@ -0,0 +1,89 @@
+#include "wayfire/signal-provider.hpp"
+#include "wayfire/util.hpp"
+#include <wayland-server-core.h>
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+struct signal_a
+{
+    int value;
+};
+
+struct signal_b
+{
+    int value;
+};
+
+TEST_CASE("Signals are dispatched by type")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    wf::signal::provider_t provider;
+
+    int sum_a = 0, sum_b = 0;
+    wf::signal::connection_t<signal_a> on_a1 = [&] (signal_a *ev) { sum_a += ev->value; };
+    wf::signal::connection_t<signal_a> on_a2 = [&] (signal_a *ev) { sum_a += 10 * ev->value; };
+    wf::signal::connection_t<signal_b> on_b  = [&] (signal_b *ev) { sum_b += ev->value; };
+
+    provider.connect(&on_a1);
+    provider.connect(&on_b);
+    provider.connect(&on_a2);
+
+    signal_a a{1};
+    provider.emit(&a);
+    REQUIRE(sum_a == 11);
+    REQUIRE(sum_b == 0);
+
+    signal_b b{2};
+    provider.emit(&b);
+    REQUIRE(sum_a == 11);
+    REQUIRE(sum_b == 2);
+
+    on_a1.disconnect();
+    provider.emit(&a);
+    REQUIRE(sum_a == 21);
+    REQUIRE(sum_b == 2);
+}
+
+TEST_CASE("Connections may be disconnected and connected during emit")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    wf::signal::provider_t provider;
+
+    int count_a = 0, count_b = 0;
+    wf::signal::connection_t<signal_b> on_b = [&] (signal_b*) { ++count_b; };
+    wf::signal::connection_t<signal_a> on_a = [&] (signal_a*)
+    {
+        ++count_a;
+        on_a.disconnect();
+        // Connecting to a new signal type must not invalidate the list which is being iterated.
+        provider.connect(&on_b);
+    };
+
+    provider.connect(&on_a);
+    signal_a a{0};
+    provider.emit(&a);
+    provider.emit(&a);
+    REQUIRE(count_a == 1);
+
+    signal_b b{0};
+    provider.emit(&b);
+    REQUIRE(count_b == 1);
+}
+
+TEST_CASE("Destroying the provider disconnects all connections")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    wf::signal::connection_t<signal_a> on_a = [&] (signal_a*) {};
+    wf::signal::connection_t<signal_b> on_b = [&] (signal_b*) {};
+
+    {
+        wf::signal::provider_t provider;
+        provider.connect(&on_a);
+        provider.connect(&on_b);
+        REQUIRE(on_a.is_connected());
+        REQUIRE(on_b.is_connected());
+    }
+
+    REQUIRE(!on_a.is_connected());
+    REQUIRE(!on_b.is_connected());
+}
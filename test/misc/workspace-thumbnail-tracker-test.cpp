@@ -0,0 +1,76 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include "workspace-thumbnail-tracker.hpp"
+
+static const wf::dimensions_t grid = {3, 2};
+static const wf::dimensions_t thumb_size = {640, 360};
+
+static bool same_region(const wf::region_t& a, const wf::region_t& b)
+{
+    return (a ^ b).empty() && (b ^ a).empty();
+}
+
+TEST_CASE("Painted thumbnails are reused until damaged")
+{
+    wf::workspace_thumbnail_tracker_t tracker;
+    REQUIRE_FALSE(tracker.is_valid({1, 0}, thumb_size));
+
+    // Paint all thumbnails in round-robin order
+    for (int i = 0; i < grid.width * grid.height; i++)
+    {
+        auto ws = tracker.next_outdated(grid, thumb_size);
+        REQUIRE(ws.has_value());
+        const wf::point_t expected = {i % grid.width, i / grid.width};
+        REQUIRE(*ws == expected);
+        tracker.set_painted(*ws, thumb_size);
+    }
+
+    REQUIRE_FALSE(tracker.next_outdated(grid, thumb_size).has_value());
+    REQUIRE(tracker.is_valid({1, 0}, thumb_size));
+    REQUIRE(tracker.get_damage({1, 0}).empty());
+
+    // Damage on one workspace outdates only its thumbnail
+    const wf::point_t damaged_ws = {2, 1};
+    const wf::geometry_t damage  = {10, 10, 100, 100};
+    tracker.add_damage(damaged_ws, damage);
+    REQUIRE(tracker.is_valid(damaged_ws, thumb_size));
+    REQUIRE(same_region(tracker.get_damage(damaged_ws), damage));
+    REQUIRE(tracker.next_outdated(grid, thumb_size) == damaged_ws);
+
+    tracker.set_painted(damaged_ws, thumb_size);
+    REQUIRE_FALSE(tracker.next_outdated(grid, thumb_size).has_value());
+}
+
+TEST_CASE("Stored thumbnails keep the damage of the source buffer")
+{
+    wf::workspace_thumbnail_tracker_t tracker;
+    const wf::region_t damage{wf::geometry_t{0, 0, 50, 50}};
+    tracker.set_painted({0, 1}, thumb_size, damage);
+
+    REQUIRE(tracker.is_valid({0, 1}, thumb_size));
+    REQUIRE(same_region(tracker.get_damage({0, 1}), damage));
+
+    const wf::geometry_t new_damage = {100, 100, 10, 10};
+    tracker.add_damage({0, 1}, new_damage);
+    REQUIRE(same_region(tracker.get_damage({0, 1}), damage | new_damage));
+}
+
+TEST_CASE("Thumbnails are invalidated by size changes and resets")
+{
+    wf::workspace_thumbnail_tracker_t tracker;
+    tracker.set_painted({0, 0}, thumb_size);
+    tracker.set_painted({1, 0}, thumb_size);
+
+    // For example, the output scale changed
+    const wf::dimensions_t new_size = {1280, 720};
+    REQUIRE_FALSE(tracker.is_valid({0, 0}, new_size));
+    const wf::point_t first_ws = {0, 0};
+    REQUIRE(tracker.next_outdated(grid, new_size) == first_ws);
+
+    // For example, the workspace grid changed
+    tracker.reset();
+    REQUIRE_FALSE(tracker.is_valid({1, 0}, thumb_size));
+    REQUIRE(tracker.get_damage({1, 0}).empty());
+    REQUIRE(tracker.next_outdated(grid, thumb_size) == first_ws);
+}
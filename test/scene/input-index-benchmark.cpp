@@ -0,0 +1,250 @@
+#include <wayfire/scene.hpp>
+#include <wayfire/unstable/translation-node.hpp>
+#include <wayfire/util.hpp>
+#include <wayland-server-core.h>
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+/**
+ * A leaf node which accepts input everywhere in its bounding box, similar to a view with a single surface.
+ */
+class rect_node_t : public wf::scene::node_t
+{
+  public:
+    wf::geometry_t geometry;
+    bool bounded;
+
+    rect_node_t(wf::geometry_t geometry, bool bounded = true) : node_t(false)
+    {
+        this->geometry = geometry;
+        this->bounded  = bounded;
+    }
+
+    std::optional<wf::scene::input_node_t> find_node_at(const wf::pointf_t& at) override
+    {
+        if (!bounded || (geometry & at))
+        {
+            return wf::scene::input_node_t{
+                .node = this,
+                .local_coords = at,
+            };
+        }
+
+        return {};
+    }
+
+    wf::geometry_t get_bounding_box() override
+    {
+        return bounded ? geometry : wf::geometry_t{0, 0, 0, 0};
+    }
+
+    bool has_bounded_input() override
+    {
+        return bounded;
+    }
+};
+
+/**
+ * An inner node which accepts input only inside of its children, similar to the root node of a view.
+ */
+class bounded_inner_node_t : public wf::scene::floating_inner_node_t
+{
+  public:
+    using floating_inner_node_t::floating_inner_node_t;
+
+    bool has_bounded_input() override
+    {
+        return true;
+    }
+};
+
+static std::shared_ptr<wf::scene::floating_inner_node_t> make_scene(int nr_nodes, std::mt19937& gen)
+{
+    std::uniform_int_distribution<int> pos(0, 3840);
+    std::uniform_int_distribution<int> size(50, 1000);
+
+    std::vector<wf::scene::node_ptr> children;
+    for (int i = 0; i < nr_nodes; i++)
+    {
+        children.push_back(std::make_shared<rect_node_t>(
+            wf::geometry_t{pos(gen), pos(gen), size(gen), size(gen)}));
+    }
+
+    auto root = std::make_shared<wf::scene::floating_inner_node_t>(false);
+    root->set_children_list(children);
+    return root;
+}
+
+static wf::scene::node_t *find_reference(wf::scene::node_t *root, const wf::pointf_t& at)
+{
+    for (auto& ch : root->get_children())
+    {
+        if (!ch->is_enabled())
+        {
+            continue;
+        }
+
+        if (auto isec = ch->find_node_at(at))
+        {
+            return isec->node.get();
+        }
+    }
+
+    return nullptr;
+}
+
+static std::vector<wf::pointf_t> random_points(int count, std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> coord(-100, 5000);
+    std::vector<wf::pointf_t> points;
+    for (int i = 0; i < count; i++)
+    {
+        points.push_back({coord(gen), coord(gen)});
+    }
+
+    return points;
+}
+
+TEST_CASE("Indexed hit-testing matches linear search")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    std::mt19937 gen(42);
+
+    for (int nr_nodes : {1, 7, 8, 10, 100, 1000})
+    {
+        auto root   = make_scene(nr_nodes, gen);
+        auto points = random_points(1000, gen);
+        for (auto& p : points)
+        {
+            auto isec = root->find_node_at(p);
+            REQUIRE((isec ? isec->node.get() : nullptr) == find_reference(root.get(), p));
+        }
+    }
+}
+
+TEST_CASE("Unbounded and disabled children are respected")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    std::mt19937 gen(7);
+
+    auto root     = make_scene(20, gen);
+    auto children = root->get_children();
+    auto grab     = std::make_shared<rect_node_t>(wf::geometry_t{0, 0, 0, 0}, false);
+    children.insert(children.begin() + 10, grab);
+    root->set_children_list(children);
+
+    for (auto& p : random_points(1000, gen))
+    {
+        auto isec = root->find_node_at(p);
+        REQUIRE(isec.has_value());
+        REQUIRE(isec->node.get() == find_reference(root.get(), p));
+    }
+
+    grab->set_enabled(false);
+    for (auto& p : random_points(1000, gen))
+    {
+        auto isec = root->find_node_at(p);
+        REQUIRE((isec ? isec->node.get() : nullptr) == find_reference(root.get(), p));
+    }
+}
+
+TEST_CASE("Index follows geometry changes of children")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    std::mt19937 gen(99);
+
+    auto root = make_scene(50, gen);
+    auto moved_node = std::dynamic_pointer_cast<rect_node_t>(root->get_children()[5]);
+    const wf::pointf_t target{5000, 5000};
+
+    // Build the index
+    REQUIRE_FALSE(root->find_node_at(target).has_value());
+
+    moved_node->geometry = {4900, 4900, 200, 200};
+    wf::scene::invalidate_input_index(moved_node.get());
+    auto isec = root->find_node_at(target);
+    REQUIRE(isec.has_value());
+    REQUIRE(isec->node.get() == moved_node.get());
+
+    for (auto& p : random_points(1000, gen))
+    {
+        isec = root->find_node_at(p);
+        REQUIRE((isec ? isec->node.get() : nullptr) == find_reference(root.get(), p));
+    }
+}
+
+TEST_CASE("Index follows offset changes of translation nodes")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    std::mt19937 gen(5);
+
+    // Similar to a view with a subsurface, which moves when the subsurface position changes.
+    auto surface = std::make_shared<rect_node_t>(wf::geometry_t{0, 0, 100, 100});
+    auto translation = std::make_shared<wf::scene::translation_node_t>(false);
+    translation->set_children_list({surface});
+    auto view = std::make_shared<bounded_inner_node_t>(false);
+    view->set_children_list({translation});
+
+    auto root = make_scene(50, gen);
+    auto children = root->get_children();
+    children.insert(children.begin(), view);
+    root->set_children_list(children);
+
+    const wf::pointf_t target{4950, 4950};
+    // Build the index
+    REQUIRE_FALSE(root->find_node_at(target).has_value());
+
+    translation->set_offset({4900, 4900});
+    auto isec = root->find_node_at(target);
+    REQUIRE(isec.has_value());
+    REQUIRE(isec->node.get() == surface.get());
+
+    for (auto& p : random_points(1000, gen))
+    {
+        isec = root->find_node_at(p);
+        REQUIRE((isec ? isec->node.get() : nullptr) == find_reference(root.get(), p));
+    }
+}
+
+TEST_CASE("Benchmark hit-testing")
+{
+    wf::wl_idle_call::loop = wl_event_loop_create();
+    std::mt19937 gen(1234);
+
+    for (int nr_nodes : {10, 100, 1000})
+    {
+        auto root   = make_scene(nr_nodes, gen);
+        auto points = random_points(100000, gen);
+
+        size_t hits = 0;
+        auto start  = std::chrono::steady_clock::now();
+        for (auto& p : points)
+        {
+            hits += root->find_node_at(p).has_value();
+        }
+
+        auto indexed = std::chrono::steady_clock::now() - start;
+
+        size_t ref_hits = 0;
+        start = std::chrono::steady_clock::now();
+        for (auto& p : points)
+        {
+            ref_hits += (find_reference(root.get(), p) != nullptr);
+        }
+
+        auto linear = std::chrono::steady_clock::now() - start;
+        REQUIRE(hits == ref_hits);
+
+        auto per_sec = [&] (auto duration)
+        {
+            return (uint64_t)(points.size() / std::chrono::duration<double>(duration).count());
+        };
+
+        std::cout << nr_nodes << " nodes: " << per_sec(indexed) << " lookups/s indexed, " <<
+            per_sec(linear) << " lookups/s linear" << std::endl;
+    }
+}
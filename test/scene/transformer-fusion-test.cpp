@@ -0,0 +1,53 @@
+#include <wayfire/view-transform.hpp>
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <glm/gtc/matrix_transform.hpp>
+
+/**
+ * Compute the total transform of a view_3d_transformer_t with the given children box and rotation, like
+ * view_3d_transformer_t::calculate_total_transform().
+ */
+static glm::mat4 make_3d_transform(wf::geometry_t box, glm::mat4 rotation, glm::mat4 translation)
+{
+    float scale = std::max(box.width, box.height);
+    glm::mat4 depth_scale = glm::scale(glm::mat4(1.0), {1, 1, 2.0 / scale});
+    glm::mat4 view_proj   = wf::view_3d_transformer_t::default_proj_matrix() *
+        wf::view_3d_transformer_t::default_view_matrix();
+    return translation * view_proj * depth_scale * rotation;
+}
+
+static wf::pointf_t apply_matrix(const glm::mat4& matrix, wf::pointf_t point)
+{
+    glm::vec4 v = matrix * glm::vec4{point.x, point.y, 0, 1};
+    return {v.x / v.w, v.y / v.w};
+}
+
+TEST_CASE("Fused 3D transformers match the separate transformers")
+{
+    const wf::geometry_t inner_box = {100, 200, 800, 600};
+    const auto inner = make_3d_transform(inner_box,
+        glm::rotate(glm::mat4(1.0), 0.6f, {0, 1, 0}), glm::mat4(1.0));
+
+    // The outer transformer contains the inner one, so its children box is the transformed inner box.
+    const wf::geometry_t outer_box = {120, 180, 760, 640};
+    const auto outer = make_3d_transform(outer_box,
+        glm::rotate(glm::mat4(1.0), -0.4f, {1, 1, 0}),
+        glm::translate(glm::mat4(1.0), {0.1, -0.05, 0}));
+
+    const auto fused = wf::scene::fuse_transform_matrices({
+        wf::scene::get_3d_transform_matrix(outer_box, outer),
+        wf::scene::get_3d_transform_matrix(inner_box, inner),
+    });
+
+    for (wf::pointf_t point : {wf::pointf_t{100, 200}, wf::pointf_t{900, 200},
+        wf::pointf_t{100, 800}, wf::pointf_t{900, 800}, wf::pointf_t{450, 530}})
+    {
+        auto expected = wf::scene::apply_3d_transform(outer_box, outer,
+            wf::scene::apply_3d_transform(inner_box, inner, point));
+        auto actual = apply_matrix(fused, point);
+        REQUIRE(actual.x == doctest::Approx(expected.x).epsilon(1e-4));
+        REQUIRE(actual.y == doctest::Approx(expected.y).epsilon(1e-4));
+    }
+}
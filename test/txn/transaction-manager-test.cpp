@@ -4,6 +4,7 @@
 #include <wayfire/util/log.hpp>
 #include <wayfire/debug.hpp>
 #include <wayland-server-core.h>
+#include <chrono>
 #define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 #include <doctest/doctest.h>
 
@@ -290,3 +291,127 @@ TEST_CASE("Concurrent committed")
     REQUIRE(mgr.pending.size() == 0);
     REQUIRE(mgr.done.size() == 2);
 }
+
+static std::vector<std::shared_ptr<txn_test_object_t>> make_objects(int count)
+{
+    std::vector<std::shared_ptr<txn_test_object_t>> objects;
+    for (int i = 0; i < count; i++)
+    {
+        objects.push_back(std::make_shared<txn_test_object_t>(false));
+    }
+
+    return objects;
+}
+
+TEST_CASE("Many chained transactions are merged quickly")
+{
+    setup_wayfire_debugging_state();
+    wf::log::enabled_categories.reset();
+    wf::txn::transaction_manager_t::impl mgr;
+
+    const int nr_objects = 1000;
+    const int nr_tx = 100;
+    auto objects    = make_objects(nr_objects);
+
+    // Block all objects, so that the following transactions stay pending.
+    auto blocker = new_tx();
+    for (auto& obj : objects)
+    {
+        blocker->add_object(obj);
+    }
+
+    mgr.schedule_transaction(std::move(blocker));
+    REQUIRE(mgr.committed.size() == 1);
+
+    // Every transaction shares an object with the previous one, so they all have to be merged together.
+    const int per_tx = nr_objects / nr_tx;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < nr_tx; i++)
+    {
+        auto tx = new_tx();
+        if (i > 0)
+        {
+            tx->add_object(objects[i * per_tx - 1]);
+        }
+
+        for (int j = 0; j < per_tx; j++)
+        {
+            tx->add_object(objects[i * per_tx + j]);
+        }
+
+        mgr.schedule_transaction(std::move(tx));
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(elapsed < std::chrono::milliseconds(100));
+    REQUIRE(mgr.pending.size() == 1);
+    REQUIRE(mgr.pending.front()->get_objects().size() == nr_objects);
+
+    // Unblock, the merged transaction is committed.
+    for (auto& obj : objects)
+    {
+        obj->emit_ready();
+    }
+
+    REQUIRE(mgr.committed.size() == 1);
+    REQUIRE(mgr.pending.size() == 0);
+    for (auto& obj : objects)
+    {
+        REQUIRE(obj->number_committed == 2);
+        obj->emit_ready();
+    }
+
+    REQUIRE(mgr.committed.size() == 0);
+    for (auto& obj : objects)
+    {
+        REQUIRE(obj->number_applied == 2);
+    }
+}
+
+TEST_CASE("Many independent transactions are scheduled quickly")
+{
+    setup_wayfire_debugging_state();
+    wf::log::enabled_categories.reset();
+    wf::txn::transaction_manager_t::impl mgr;
+
+    const int nr_objects = 1000;
+    const int nr_tx = 100;
+    auto objects    = make_objects(nr_objects);
+
+    // Schedule each batch of objects twice: the first round is committed immediately, the second has to
+    // wait for the first one.
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 2; round++)
+    {
+        for (int i = 0; i < nr_tx; i++)
+        {
+            auto tx = new_tx();
+            for (int j = i; j < nr_objects; j += nr_tx)
+            {
+                tx->add_object(objects[j]);
+            }
+
+            mgr.schedule_transaction(std::move(tx));
+        }
+    }
+
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    REQUIRE(elapsed < std::chrono::milliseconds(100));
+    REQUIRE(mgr.committed.size() == nr_tx);
+    REQUIRE(mgr.pending.size() == nr_tx);
+
+    for (auto& obj : objects)
+    {
+        REQUIRE(obj->number_committed == 1);
+        obj->emit_ready();
+    }
+
+    REQUIRE(mgr.committed.size() == nr_tx);
+    REQUIRE(mgr.pending.size() == 0);
+    REQUIRE(mgr.done.size() == nr_tx);
+    for (auto& obj : objects)
+    {
+        REQUIRE(obj->number_applied == 1);
+        REQUIRE(obj->number_committed == 2);
+    }
+}
@@ -0,0 +1,251 @@
+#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
+#include <doctest/doctest.h>
+
+extern "C"
+{
+#include "wobbly-kernel.h"
+}
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/*
+ * The previous implementation of the spring model, with one object struct per
+ * grid point and a list of springs, used as a reference for the kernels.
+ */
+namespace reference
+{
+struct object_t
+{
+    float force_x = 0, force_y = 0;
+    float position_x = 0, position_y = 0;
+    float velocity_x = 0, velocity_y = 0;
+    float theta = 0;
+    int immobile = 0;
+};
+
+struct spring_t
+{
+    object_t *a, *b;
+    float offset_x, offset_y;
+};
+
+struct model_t
+{
+    object_t objects[WOBBLY_OBJECTS];
+    std::vector<spring_t> springs;
+
+    void init_springs(float hpad, float vpad)
+    {
+        springs.clear();
+        for (int i = 0; i < WOBBLY_OBJECTS; i++)
+        {
+            if (i % WOBBLY_GRID_WIDTH > 0)
+            {
+                springs.push_back({&objects[i - 1], &objects[i], hpad, 0});
+            }
+
+            if (i / WOBBLY_GRID_WIDTH > 0)
+            {
+                springs.push_back({&objects[i - WOBBLY_GRID_WIDTH], &objects[i], 0, vpad});
+            }
+        }
+    }
+
+    void step(int steps, float friction, float k, float& velocity_sum, float& force_sum)
+    {
+        velocity_sum = force_sum = 0;
+        for (int j = 0; j < steps; j++)
+        {
+            for (auto& s : springs)
+            {
+                float dax = 0.5f * (s.b->position_x - s.a->position_x - s.offset_x);
+                float day = 0.5f * (s.b->position_y - s.a->position_y - s.offset_y);
+                float dbx = 0.5f * (s.a->position_x - s.b->position_x + s.offset_x);
+                float dby = 0.5f * (s.a->position_y - s.b->position_y + s.offset_y);
+                s.a->force_x += k * dax;
+                s.a->force_y += k * day;
+                s.b->force_x += k * dbx;
+                s.b->force_y += k * dby;
+            }
+
+            for (auto& o : objects)
+            {
+                o.theta += 0.05f;
+                if (o.immobile)
+                {
+                    o.velocity_x = o.velocity_y = 0.0f;
+                    o.force_x    = o.force_y = 0.0f;
+                    continue;
+                }
+
+                o.force_x    -= friction * o.velocity_x;
+                o.force_y    -= friction * o.velocity_y;
+                o.velocity_x += o.force_x / WOBBLY_MASS;
+                o.velocity_y += o.force_y / WOBBLY_MASS;
+                o.position_x += o.velocity_x;
+                o.position_y += o.velocity_y;
+                velocity_sum += std::fabs(o.velocity_x) + std::fabs(o.velocity_y);
+                force_sum    += std::fabs(o.force_x) + std::fabs(o.force_y);
+                o.force_x     = o.force_y = 0.0f;
+            }
+        }
+    }
+};
+}
+
+/* A model which was just grabbed and dragged away, in both representations. */
+static void make_model(std::mt19937& gen, reference::model_t& ref, wobbly_objects& soa)
+{
+    std::uniform_real_distribution<float> pos(0, 2000), size(100, 1500), kick(-30, 30);
+    const float x = pos(gen), y = pos(gen), w = size(gen), h = size(gen);
+    const int anchor = std::uniform_int_distribution<int>(0, WOBBLY_OBJECTS - 1)(gen);
+
+    std::memset(&soa, 0, sizeof(soa));
+    soa.hpad = w / (WOBBLY_GRID_WIDTH - 1);
+    soa.vpad = h / (WOBBLY_GRID_HEIGHT - 1);
+    ref.init_springs(soa.hpad, soa.vpad);
+
+    for (int i = 0; i < WOBBLY_OBJECTS; i++)
+    {
+        auto& o = ref.objects[i];
+        o = {};
+        o.position_x = x + (i % WOBBLY_GRID_WIDTH) * soa.hpad + kick(gen);
+        o.position_y = y + (i / WOBBLY_GRID_WIDTH) * soa.vpad + kick(gen);
+        o.velocity_x = kick(gen) * 0.1f;
+        o.velocity_y = kick(gen) * 0.1f;
+        o.immobile   = (i == anchor);
+
+        WOBBLY_X(&soa, i)  = o.position_x;
+        WOBBLY_Y(&soa, i)  = o.position_y;
+        soa.velocity_x[i] = o.velocity_x;
+        soa.velocity_y[i] = o.velocity_y;
+        soa.mobile[i]     = o.immobile ? 0.0f : 1.0f;
+    }
+}
+
+static void check_close(float a, float b, float tolerance)
+{
+    CHECK(std::fabs(a - b) <= tolerance * std::max(1.0f, std::fabs(b)));
+}
+
+static void check_equivalent(const reference::model_t& ref, const wobbly_objects& soa, float tolerance)
+{
+    for (int i = 0; i < WOBBLY_OBJECTS; i++)
+    {
+        check_close(WOBBLY_X(&soa, i), ref.objects[i].position_x, tolerance);
+        check_close(WOBBLY_Y(&soa, i), ref.objects[i].position_y, tolerance);
+        check_close(soa.velocity_x[i], ref.objects[i].velocity_x, tolerance);
+        check_close(soa.velocity_y[i], ref.objects[i].velocity_y, tolerance);
+        check_close(soa.theta[i], ref.objects[i].theta, tolerance);
+    }
+}
+
+using step_function = void (*)(wobbly_step_request*, int, float, float);
+static void test_equivalence(step_function step, float tolerance)
+{
+    std::mt19937 gen(42);
+    const float friction = 3.0f, k = 8.0f;
+
+    for (int m = 0; m < 64; m++)
+    {
+        reference::model_t ref;
+        wobbly_objects soa;
+        make_model(gen, ref, soa);
+
+        // Step in chunks like a compositor would, for about 2 seconds of animation.
+        for (int frame = 0; frame < 120; frame++)
+        {
+            const int steps = 1 + frame % 2;
+            float velocity_sum, force_sum;
+            ref.step(steps, friction, k, velocity_sum, force_sum);
+
+            wobbly_step_request request{&soa, steps, 0, 0};
+            step(&request, 1, friction, k);
+            check_close(request.velocity_sum, velocity_sum, tolerance);
+            check_close(request.force_sum, force_sum, tolerance);
+        }
+
+        check_equivalent(ref, soa, tolerance);
+    }
+}
+
+TEST_CASE("Scalar kernel is equivalent to the reference model")
+{
+    test_equivalence(wobbly_step_models_scalar, 1e-5);
+}
+
+TEST_CASE("Vector kernel is equivalent to the reference model")
+{
+    // Only the order in which the velocities and forces are summed differs.
+    test_equivalence(wobbly_step_models, 1e-5);
+}
+
+TEST_CASE("Benchmark wobbly model stepping")
+{
+    const int models = 64, iterations = 2000;
+    const float friction = 3.0f, k = 8.0f;
+    std::mt19937 gen(1234);
+
+    std::vector<reference::model_t> ref(models);
+    std::vector<wobbly_objects> scalar(models), vector(models);
+    for (int i = 0; i < models; i++)
+    {
+        make_model(gen, ref[i], scalar[i]);
+        vector[i] = scalar[i];
+    }
+
+    std::vector<wobbly_step_request> scalar_requests, vector_requests;
+    for (int i = 0; i < models; i++)
+    {
+        scalar_requests.push_back({&scalar[i], 1, 0, 0});
+        vector_requests.push_back({&vector[i], 1, 0, 0});
+    }
+
+    float velocity_sum, force_sum;
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++)
+    {
+        for (auto& model : ref)
+        {
+            model.step(1, friction, k, velocity_sum, force_sum);
+        }
+    }
+
+    auto reference_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++)
+    {
+        wobbly_step_models_scalar(scalar_requests.data(), models, friction, k);
+    }
+
+    auto scalar_time = std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++)
+    {
+        wobbly_step_models(vector_requests.data(), models, friction, k);
+    }
+
+    auto vector_time = std::chrono::steady_clock::now() - start;
+
+    for (int i = 0; i < models; i++)
+    {
+        check_equivalent(ref[i], vector[i], 1e-5);
+    }
+
+    auto per_sec = [&] (auto duration)
+    {
+        return (uint64_t)(1.0 * models * iterations / std::chrono::duration<double>(duration).count());
+    };
+
+    std::cout << models << " models x " << iterations << " steps: " <<
+        per_sec(vector_time) << " model steps/s vectorized, " <<
+        per_sec(scalar_time) << " model steps/s scalar SoA, " <<
+        per_sec(reference_time) << " model steps/s previous implementation" << std::endl;
+}